@@ -0,0 +1,11 @@
+# Audio ring component - lock-free single-producer/single-consumer ring of audio frames
+# Auto-loaded by the audio components that hand audio between two tasks
+import esphome.codegen as cg
+import esphome.config_validation as cv
+
+CODEOWNERS = ["@kahrendt"]
+
+audio_ring_ns = cg.esphome_ns.namespace("audio_ring")
+AudioRing = audio_ring_ns.class_("AudioRing")
+
+CONFIG_SCHEMA = cv.All(cv.Schema({}))
@@ -0,0 +1,231 @@
+#include "audio_ring.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/helpers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace esphome::audio_ring {
+
+std::unique_ptr<AudioRing> AudioRing::create(size_t capacity_bytes, size_t frame_bytes) {
+  std::unique_ptr<AudioRing> ring(new (std::nothrow) AudioRing());
+  if (ring == nullptr) {
+    return nullptr;
+  }
+  ring->storage_bytes_ = capacity_bytes;
+  RAMAllocator<uint8_t> allocator;
+  ring->storage_ = allocator.allocate(ring->storage_bytes_ + WRAP_SLACK_BYTES);
+  if (ring->storage_ == nullptr) {
+    return nullptr;
+  }
+  ring->set_frame_bytes(frame_bytes);
+  return ring;
+}
+
+AudioRing::~AudioRing() {
+  if (this->storage_ != nullptr) {
+    RAMAllocator<uint8_t> allocator;
+    allocator.deallocate(this->storage_, this->storage_bytes_ + WRAP_SLACK_BYTES);
+  }
+}
+
+void AudioRing::set_frame_bytes(size_t frame_bytes) {
+  this->frame_bytes_ = std::max<size_t>(frame_bytes, 1);
+  this->capacity_frames_ = this->storage_bytes_ / this->frame_bytes_;
+  this->head_.store(0, std::memory_order_relaxed);
+  this->tail_.store(0, std::memory_order_relaxed);
+}
+
+size_t AudioRing::available_frames() const {
+  const uint32_t tail = this->tail_.load(std::memory_order_acquire);
+  return this->used_(this->head_.load(std::memory_order_acquire), tail);
+}
+
+uint8_t *AudioRing::acquire_write(size_t &frames) {
+  const uint32_t head = this->head_.load(std::memory_order_relaxed);
+  const size_t free_frames = this->capacity_frames_ - this->used_(head, this->tail_.load(std::memory_order_acquire));
+  const size_t offset = this->offset_(head);
+  frames = std::min(free_frames, this->capacity_frames_ - offset);
+  return this->storage_ + offset * this->frame_bytes_;
+}
+
+void AudioRing::commit_write(size_t frames) {
+  const uint32_t head = this->advance_(this->head_.load(std::memory_order_relaxed), frames);
+  this->head_.store(head, std::memory_order_release);
+  // Pairs with the fence in wait_(): either the consumer sees the new head, or this sees it waiting
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  notify_(this->consumer_waiter_, this->consumer_wanted_,
+          this->used_(head, this->tail_.load(std::memory_order_relaxed)));
+}
+
+const uint8_t *AudioRing::acquire_read(size_t &frames, size_t min_frames) {
+  const uint32_t tail = this->tail_.load(std::memory_order_relaxed);
+  const size_t used = this->used_(this->head_.load(std::memory_order_acquire), tail);
+  const size_t offset = this->offset_(tail);
+  frames = std::min(used, this->capacity_frames_ - offset);
+
+  min_frames = std::min(min_frames, WRAP_SLACK_BYTES / this->frame_bytes_);
+  if ((frames < min_frames) && (used >= min_frames)) {
+    // The wrapped frames are committed and not yet released, so the producer leaves them alone; the slack behind the
+    // storage is only ever touched here
+    std::memcpy(this->storage_ + this->capacity_frames_ * this->frame_bytes_, this->storage_,
+                (min_frames - frames) * this->frame_bytes_);
+    frames = min_frames;
+  }
+  return this->storage_ + offset * this->frame_bytes_;
+}
+
+void AudioRing::commit_read(size_t frames) {
+  const uint32_t tail = this->advance_(this->tail_.load(std::memory_order_relaxed), frames);
+  this->tail_.store(tail, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  notify_(this->producer_waiter_, this->producer_wanted_,
+          this->capacity_frames_ - this->used_(this->head_.load(std::memory_order_relaxed), tail));
+}
+
+void AudioRing::reset() { this->commit_read(this->available_frames()); }
+
+template<typename Ready>
+bool AudioRing::wait_(std::atomic<TaskHandle_t> &waiter, std::atomic<uint32_t> &wanted, size_t frames, Ready ready,
+                      TickType_t ticks_to_wait) {
+  if (ready()) {
+    return true;
+  }
+  if (ticks_to_wait == 0) {
+    return false;
+  }
+
+  waiter.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+  wanted.store(frames, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  const TickType_t start = xTaskGetTickCount();
+  bool is_ready = ready();
+  while (!is_ready) {
+    const TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= ticks_to_wait) {
+      break;
+    }
+    ulTaskNotifyTake(pdTRUE, ticks_to_wait - elapsed);
+    is_ready = ready();
+  }
+  wanted.store(0, std::memory_order_relaxed);
+  return is_ready;
+}
+
+void AudioRing::notify_(std::atomic<TaskHandle_t> &waiter, std::atomic<uint32_t> &wanted, size_t frames) {
+  const uint32_t wanted_frames = wanted.load(std::memory_order_acquire);
+  if ((wanted_frames > 0) && (frames >= wanted_frames)) {
+    xTaskNotifyGive(waiter.load(std::memory_order_relaxed));
+  }
+}
+
+bool AudioRing::wait_for_free(size_t frames, TickType_t ticks_to_wait) {
+  frames = std::max<size_t>(std::min(frames, this->capacity_frames_), 1);
+  return this->wait_(
+      this->producer_waiter_, this->producer_wanted_, frames,
+      [this, frames]() { return this->free_frames() >= frames; }, ticks_to_wait);
+}
+
+bool AudioRing::wait_for_available(size_t frames, TickType_t ticks_to_wait) {
+  frames = std::max<size_t>(std::min(frames, this->capacity_frames_), 1);
+  this->wait_(
+      this->consumer_waiter_, this->consumer_wanted_, frames,
+      [this, frames]() {
+        return this->consumer_woken_.load(std::memory_order_relaxed) || (this->available_frames() >= frames);
+      },
+      ticks_to_wait);
+  const bool woken = this->consumer_woken_.exchange(false, std::memory_order_relaxed);
+  return !woken && (this->available_frames() >= frames);
+}
+
+bool AudioRing::wait_for_block(size_t frames, TickType_t partial_ticks, TickType_t empty_ticks) {
+  if ((this->available_frames() == 0) && !this->wait_for_available(1, empty_ticks)) {
+    return false;
+  }
+  return this->wait_for_available(frames, partial_ticks);
+}
+
+void AudioRing::wake_consumer() {
+  this->consumer_woken_.store(true, std::memory_order_relaxed);
+  // Pairs with the fence in wait_(): either the consumer sees the flag, or this sees it waiting
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->consumer_wanted_.load(std::memory_order_acquire) > 0) {
+    xTaskNotifyGive(this->consumer_waiter_.load(std::memory_order_relaxed));
+  }
+}
+
+size_t AudioRing::write(const uint8_t *data, size_t bytes, TickType_t ticks_to_wait) {
+  const size_t frames = bytes / this->frame_bytes_;
+  size_t frames_written = 0;
+  // The clock is only read once the call has to wait, so calls the ring satisfies at once skip it
+  TickType_t start = 0;
+  bool waiting = false;
+  while (true) {
+    // At most two runs: up to the end of the storage, then from its start
+    size_t run_frames = 0;
+    uint8_t *run = this->acquire_write(run_frames);
+    while ((run_frames > 0) && (frames_written < frames)) {
+      run_frames = std::min(run_frames, frames - frames_written);
+      std::memcpy(run, data + frames_written * this->frame_bytes_, run_frames * this->frame_bytes_);
+      this->commit_write(run_frames);
+      frames_written += run_frames;
+      run = this->acquire_write(run_frames);
+    }
+
+    if ((frames_written == frames) || (ticks_to_wait == 0)) {
+      break;
+    }
+    const TickType_t now = xTaskGetTickCount();
+    if (!waiting) {
+      start = now;
+      waiting = true;
+    }
+    const TickType_t elapsed = now - start;
+    if (elapsed >= ticks_to_wait) {
+      break;
+    }
+    this->wait_for_free(frames - frames_written, ticks_to_wait - elapsed);
+  }
+  return frames_written * this->frame_bytes_;
+}
+
+size_t AudioRing::read(uint8_t *data, size_t bytes, TickType_t ticks_to_wait) {
+  const size_t frames = bytes / this->frame_bytes_;
+  size_t frames_read = 0;
+  TickType_t start = 0;
+  bool waiting = false;
+  while (true) {
+    size_t run_frames = 0;
+    const uint8_t *run = this->acquire_read(run_frames);
+    while ((run_frames > 0) && (frames_read < frames)) {
+      run_frames = std::min(run_frames, frames - frames_read);
+      std::memcpy(data + frames_read * this->frame_bytes_, run, run_frames * this->frame_bytes_);
+      this->commit_read(run_frames);
+      frames_read += run_frames;
+      run = this->acquire_read(run_frames);
+    }
+
+    if ((frames_read == frames) || (ticks_to_wait == 0)) {
+      break;
+    }
+    const TickType_t now = xTaskGetTickCount();
+    if (!waiting) {
+      start = now;
+      waiting = true;
+    }
+    const TickType_t elapsed = now - start;
+    if (elapsed >= ticks_to_wait) {
+      break;
+    }
+    this->wait_for_available(frames - frames_read, ticks_to_wait - elapsed);
+  }
+  return frames_read * this->frame_bytes_;
+}
+
+}  // namespace esphome::audio_ring
+
+#endif  // USE_ESP32
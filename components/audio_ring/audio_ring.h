@@ -0,0 +1,133 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome::audio_ring {
+
+/// @brief Padding between the fields each side writes, so the producer and consumer never share a cache line.
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+/// @brief Lock-free single-producer, single-consumer ring of audio frames for handing a stream from one task to
+/// another. Both sides work in place: acquire a contiguous run of whole frames, read or write it directly, then commit
+/// it. Neither side ever takes a lock, and a side that wants to block waits on its own task notification, which the
+/// other side only sends once the frames it waits for are there.
+///
+/// Exactly one task may call the producer methods and exactly one the consumer methods; available() and free() are
+/// safe from any task. A waiting task's notification value is used to wake it, so other notification waits on the same
+/// task must tolerate an early wake-up.
+class AudioRing {
+ public:
+  /// @brief Largest run the consumer can ask acquire_read() to make contiguous across the end of the storage; covers
+  /// a sample pair of any supported format.
+  static constexpr size_t WRAP_SLACK_BYTES = 16;
+
+  /// @brief Allocates a ring holding `capacity_bytes` of audio, rounded down to whole frames, preferring PSRAM.
+  /// @return nullptr if the allocation failed
+  static std::unique_ptr<AudioRing> create(size_t capacity_bytes, size_t frame_bytes);
+  ~AudioRing();
+
+  /// @brief Changes the frame size and empties the ring. Only call while neither side is using it, e.g. when the
+  /// consumer switches streams and the producer is holding back audio in the new format.
+  void set_frame_bytes(size_t frame_bytes);
+  size_t get_frame_bytes() const { return this->frame_bytes_; }
+
+  /// @brief Producer: returns the longest contiguous run of free frames, without waiting.
+  /// @param frames Set to the run's length; 0 if the ring is full
+  uint8_t *acquire_write(size_t &frames);
+  /// @brief Producer: publishes the first `frames` frames of the last acquired run and wakes a waiting consumer.
+  void commit_write(size_t frames);
+  /// @brief Producer: waits up to `ticks_to_wait` until at least `frames` frames are free.
+  /// @return True if they are
+  bool wait_for_free(size_t frames, TickType_t ticks_to_wait);
+  /// @brief Producer: copies the whole frames of `data` in, waiting up to `ticks_to_wait` for space. A partial frame
+  /// at the end is never written.
+  /// @return Number of bytes written
+  size_t write(const uint8_t *data, size_t bytes, TickType_t ticks_to_wait);
+
+  /// @brief Consumer: returns the longest contiguous run of buffered frames, without waiting.
+  /// @param frames Set to the run's length; 0 if the ring is empty
+  /// @param min_frames If fewer than this many frames are contiguous but at least this many are buffered, the frames
+  /// past the end of the storage are copied behind it so the run holds `min_frames`. At most WRAP_SLACK_BYTES.
+  const uint8_t *acquire_read(size_t &frames, size_t min_frames = 1);
+  /// @brief Consumer: releases `frames` frames, read from the last acquired run or skipped unread, and wakes a waiting
+  /// producer. At most available_frames().
+  void commit_read(size_t frames);
+  /// @brief Consumer: waits up to `ticks_to_wait` until at least `frames` frames are buffered, or until
+  /// wake_consumer() is called.
+  /// @return True if they are, false if they are not or the consumer was woken
+  bool wait_for_available(size_t frames, TickType_t ticks_to_wait);
+  /// @brief Consumer: waits for a whole block of `frames` frames. An empty ring is waited on for up to `empty_ticks`;
+  /// with portMAX_DELAY an idle consumer never wakes. Once audio starts arriving, the rest of the block gets up to
+  /// `partial_ticks` so the tail of a stream is not held back. wake_consumer() cuts either wait short.
+  /// @return True if the block is there
+  bool wait_for_block(size_t frames, TickType_t partial_ticks, TickType_t empty_ticks);
+  /// @brief Consumer: copies up to `bytes` of whole frames out, waiting up to `ticks_to_wait` for them to arrive.
+  /// @return Number of bytes read
+  size_t read(uint8_t *data, size_t bytes, TickType_t ticks_to_wait);
+  /// @brief Consumer: discards every buffered frame.
+  void reset();
+
+  /// @brief Either side, or any other task: makes the consumer's current or next wait return at once, e.g. so it can
+  /// act on a command. Never lost, even if the consumer is not waiting yet.
+  void wake_consumer();
+
+  size_t available_frames() const;
+  size_t free_frames() const { return this->capacity_frames_ - this->available_frames(); }
+  /// @brief Buffered bytes, always whole frames.
+  size_t available() const { return this->available_frames() * this->frame_bytes_; }
+  /// @brief Free bytes, always whole frames.
+  size_t free() const { return this->free_frames() * this->frame_bytes_; }
+
+ protected:
+  AudioRing() = default;
+
+  /// @brief Positions run over twice the capacity so a full ring is told apart from an empty one.
+  uint32_t advance_(uint32_t position, size_t frames) const {
+    position += frames;
+    return (position >= 2 * this->capacity_frames_) ? position - 2 * this->capacity_frames_ : position;
+  }
+  size_t offset_(uint32_t position) const {
+    return (position >= this->capacity_frames_) ? position - this->capacity_frames_ : position;
+  }
+  size_t used_(uint32_t head, uint32_t tail) const {
+    return (head >= tail) ? head - tail : head + 2 * this->capacity_frames_ - tail;
+  }
+
+  /// @brief Blocks the calling task until `ready` holds or `ticks_to_wait` pass, registering it in `waiter` so the
+  /// other side notifies it once `wanted` frames are there.
+  template<typename Ready>
+  bool wait_(std::atomic<TaskHandle_t> &waiter, std::atomic<uint32_t> &wanted, size_t frames, Ready ready,
+             TickType_t ticks_to_wait);
+
+  /// @brief Notifies the task in `waiter` if it waits for no more than `frames` frames.
+  static void notify_(std::atomic<TaskHandle_t> &waiter, std::atomic<uint32_t> &wanted, size_t frames);
+
+  // Fixed while the ring is in use
+  uint8_t *storage_{nullptr};
+  size_t storage_bytes_{0};
+  size_t frame_bytes_{1};
+  size_t capacity_frames_{0};
+
+  // Written by the producer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head_{0};
+  std::atomic<TaskHandle_t> producer_waiter_{nullptr};
+  std::atomic<uint32_t> producer_wanted_{0};  // free frames the waiting producer needs; 0 while it is not waiting
+
+  // Written by the consumer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail_{0};
+  std::atomic<TaskHandle_t> consumer_waiter_{nullptr};
+  std::atomic<uint32_t> consumer_wanted_{0};  // buffered frames the waiting consumer needs; 0 while it is not waiting
+  std::atomic<bool> consumer_woken_{false};   // set by wake_consumer(), cleared by the consumer's wait
+};
+
+}  // namespace esphome::audio_ring
+
+#endif  // USE_ESP32
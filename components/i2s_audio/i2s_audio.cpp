@@ -56,7 +56,9 @@ bool I2SPortComponent::init_driver_(i2s_std_config_t std_cfg) {
       .role = this->i2s_role_,
       .dma_desc_num = this->dma_buffer_count_,
       .dma_frame_num = this->dma_buffer_length_,
-      .auto_clear = true,
+      // Clear each sent TX descriptor before the on_sent callback rather than after it, so a speaker writing directly
+      // into the reported buffer can never race the driver's memset.
+      .auto_clear_before_cb = true,
   };
 
   i2s_chan_handle_t *tx_handle_ptr = this->audio_out_ != nullptr ? &this->tx_handle_ : nullptr;
@@ -94,6 +96,12 @@ bool I2SPortComponent::init_driver_(i2s_std_config_t std_cfg) {
 }
 
 bool I2SAudioOut::start_i2s_channel(i2s_event_callbacks_t callbacks) {
+  if ((this->data_bits_per_sample_ != 0) && this->parent_->has_audio_in()) {
+    // The RX channel is set up with the same slot config and runs on the same controller, so the TX data width cannot
+    // change on its own
+    ESP_LOGE(TAG, "Narrow data words are not supported on a port shared with a microphone");
+    return false;
+  }
   if (this->parent_->tx_handle_ == nullptr) {
     if (this->parent_->rx_handle_ != nullptr) {
       ESP_LOGE(TAG, "Trying to start I2S-TX channel, but RX handle is available. This is not allowed.");
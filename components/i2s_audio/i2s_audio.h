@@ -28,6 +28,10 @@ class I2SAudioBase {
     return (this->std_slot_mask_ == I2S_STD_SLOT_LEFT || this->std_slot_mask_ == I2S_STD_SLOT_RIGHT) ? 1 : 2;
   }
   uint8_t i2s_bits_per_sample() const { return (uint8_t) this->slot_bit_width_; }
+  /// @brief Width of the data word carried in each slot; equals the slot width unless a narrower one was negotiated.
+  uint8_t i2s_data_bits_per_sample() const {
+    return (this->data_bits_per_sample_ != 0) ? this->data_bits_per_sample_ : this->i2s_bits_per_sample();
+  }
   void set_sample_rate(uint32_t sample_rate) { this->sample_rate_ = sample_rate; }
   void set_use_apll(uint32_t use_apll) { this->use_apll_ = use_apll; }
   void set_mclk_multiple(i2s_mclk_multiple_t mclk_multiple) { this->mclk_multiple_ = mclk_multiple; }
@@ -52,13 +56,14 @@ class I2SAudioBase {
   }
   i2s_std_slot_config_t get_std_slot_cfg() const {
     i2s_slot_mode_t slot_mode = this->slot_mode_;
+    const i2s_data_bit_width_t data_bit_width = (i2s_data_bit_width_t) this->i2s_data_bits_per_sample();
     i2s_std_slot_config_t std_slot_cfg;
     if (this->i2s_comm_fmt_ == "std") {
-      std_slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG((i2s_data_bit_width_t) this->slot_bit_width_, slot_mode);
+      std_slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(data_bit_width, slot_mode);
     } else if (this->i2s_comm_fmt_ == "pcm") {
-      std_slot_cfg = I2S_STD_PCM_SLOT_DEFAULT_CONFIG((i2s_data_bit_width_t) this->slot_bit_width_, slot_mode);
+      std_slot_cfg = I2S_STD_PCM_SLOT_DEFAULT_CONFIG(data_bit_width, slot_mode);
     } else {
-      std_slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG((i2s_data_bit_width_t) this->slot_bit_width_, slot_mode);
+      std_slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(data_bit_width, slot_mode);
     }
 #ifdef USE_ESP32_VARIANT_ESP32
     // There seems to be a bug on the ESP32 (non-variant) platform where setting the slot bit width higher then the bits
@@ -68,6 +73,7 @@ class I2SAudioBase {
       std_slot_cfg.ws_width = static_cast<uint32_t>(this->slot_bit_width_);
     }
 #else
+    // A narrower data word is sent MSB first and padded with zeros to the slot width, so the bus timing is unchanged
     std_slot_cfg.slot_bit_width = this->slot_bit_width_;
 #endif
     std_slot_cfg.slot_mask = this->std_slot_mask_;
@@ -89,6 +95,7 @@ class I2SAudioBase {
   i2s_slot_mode_t slot_mode_;
   i2s_std_slot_mask_t std_slot_mask_;
   i2s_slot_bit_width_t slot_bit_width_;
+  uint8_t data_bits_per_sample_{0};  // 0 carries data as wide as the slot
   std::string i2s_comm_fmt_;
   uint32_t sample_rate_;
   bool use_apll_;
@@ -122,6 +129,7 @@ class I2SPortComponent : public Component {
 
   void set_audio_in(I2SAudioIn *comp_in) { this->audio_in_ = comp_in; }
   void set_audio_out(I2SAudioOut *comp_out) { this->audio_out_ = comp_out; }
+  bool has_audio_in() const { return this->audio_in_ != nullptr; }
 
   void set_i2s_role(i2s_role_t role) { this->i2s_role_ = role; }
   i2s_chan_handle_t get_tx_handle() const { return this->tx_handle_; }
@@ -177,7 +185,7 @@ class I2SAudioOut : public I2SAudioBase, public Parented<I2SPortComponent> {
   gpio_num_t get_dout_pin() { return this->dout_pin_; }
 
   size_t get_dma_buffer_size_bytes() const {
-    return this->parent_->dma_buffer_length_ * this->num_of_channels() * this->i2s_bits_per_sample() / 8;
+    return this->parent_->dma_buffer_length_ * this->num_of_channels() * this->i2s_data_bits_per_sample() / 8;
   }
   size_t get_dma_buffer_size_ms() const { return this->parent_->dma_buffer_length_ * 1000 / this->sample_rate_; }
   uint8_t get_dma_buffer_count() const { return this->parent_->dma_buffer_count_; }
@@ -1,17 +1,30 @@
 from esphome import pins
 import esphome.codegen as cg
-from esphome.components import audio, esp32, speaker
+from esphome.components import audio, esp32, sensor, speaker
+from esphome.components.light.effects import register_addressable_effect
+from esphome.components.light.types import AddressableLightEffect
+from esphome.components.timed_speaker import TimedSpeaker
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_BITS_PER_SAMPLE,
     CONF_BUFFER_DURATION,
     CONF_CHANNEL,
+    CONF_FREQUENCY,
+    CONF_GAIN,
     CONF_ID,
     CONF_MODE,
+    CONF_NAME,
     CONF_NEVER,
     CONF_NUM_CHANNELS,
     CONF_SAMPLE_RATE,
-    CONF_TIMEOUT
+    CONF_THRESHOLD,
+    CONF_TIMEOUT,
+    CONF_TYPE,
+    CONF_UPDATE_INTERVAL,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
 )
 
 from .. import (
@@ -29,21 +42,78 @@ from .. import (
     validate_mclk_divisible_by_3,
 )
 
-AUTO_LOAD = ["audio"]
+AUTO_LOAD = ["audio", "audio_ring", "sensor", "timed_speaker"]
 CODEOWNERS = ["@jesserockz", "@kahrendt","@gnumpi"]
 DEPENDENCIES = ["i2s_audio"]
 
 I2SAudioSpeakerBase = i2s_audio_ns.class_(
-    "I2SAudioSpeakerBase", cg.Component, speaker.Speaker, I2SAudioOut
+    "I2SAudioSpeakerBase", cg.Component, speaker.Speaker, I2SAudioOut, TimedSpeaker
 )
 I2SAudioSpeaker = i2s_audio_ns.class_("I2SAudioSpeaker", I2SAudioSpeakerBase)
+AudioReactiveLightEffect = i2s_audio_ns.class_(
+    "AudioReactiveLightEffect", AddressableLightEffect
+)
 
 CONF_MUTE_PIN = "mute_pin"
 CONF_DAC_TYPE = "dac_type"
 CONF_I2S_COMM_FMT = "i2s_comm_fmt"
+CONF_DIRECT_DMA_WRITE = "direct_dma_write"
+CONF_SEAMLESS_UNDERFLOW = "seamless_underflow"
+CONF_SYNC_MODE = "sync_mode"
+CONF_START_WATERMARK = "start_watermark"
+CONF_RESUME_WATERMARK = "resume_watermark"
+CONF_ADAPTIVE_WATERMARK = "adaptive_watermark"
+CONF_WATERMARK_SENSOR = "watermark_sensor"
+CONF_UNDERFLOW_RATE_SENSOR = "underflow_rate_sensor"
+CONF_WARM_STANDBY = "warm_standby"
+CONF_NARROW_DMA_DATA = "narrow_dma_data"
+CONF_SPEAKERS = "speakers"
+CONF_DECAY = "decay"
+CONF_TIME_TO_FIRST_SAMPLE_SENSOR = "time_to_first_sample_sensor"
+CONF_EQUALIZER = "equalizer"
+CONF_Q = "q"
+CONF_LIMITER = "limiter"
+CONF_LOOK_AHEAD = "look_ahead"
+CONF_RELEASE = "release"
+CONF_TASK_PROFILING = "task_profiling"
+CONF_DMA_MARGIN_SENSOR = "dma_margin_sensor"
+CONF_TASK_LOAD_SENSOR = "task_load_sensor"
+
+UNIT_UNDERFLOWS_PER_MINUTE = "underflows/min"
 
 I2SCommFmt = i2s_audio_ns.enum("I2SCommFmt", is_class=True)
 
+BiquadType = i2s_audio_ns.enum("BiquadType", is_class=True)
+BIQUAD_TYPES = {
+    "peaking": BiquadType.PEAKING,
+    "low_shelf": BiquadType.LOW_SHELF,
+    "high_shelf": BiquadType.HIGH_SHELF,
+    "low_pass": BiquadType.LOW_PASS,
+    "high_pass": BiquadType.HIGH_PASS,
+    "band_pass": BiquadType.BAND_PASS,
+}
+
+BIQUAD_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_TYPE): cv.enum(BIQUAD_TYPES, lower=True),
+        cv.Required(CONF_FREQUENCY): cv.frequency,
+        # Coefficients are Q28, which keeps shelves and peaks within +/-12 dB representable
+        cv.Optional(CONF_GAIN, default=0.0): cv.float_range(min=-12.0, max=12.0),
+        cv.Optional(CONF_Q, default=0.707): cv.float_range(min=0.1, max=20.0),
+    }
+)
+
+LIMITER_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_THRESHOLD, default=-1.0): cv.float_range(min=-24.0, max=0.0),
+        cv.Optional(CONF_LOOK_AHEAD, default="1ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=1), max=cv.TimePeriod(milliseconds=10)),
+        ),
+        cv.Optional(CONF_RELEASE, default="100ms"): cv.positive_time_period_milliseconds,
+    }
+)
+
 i2s_dac_mode_t = cg.global_ns.enum("i2s_dac_mode_t")
 INTERNAL_DAC_OPTIONS = {
     CONF_LEFT: i2s_dac_mode_t.I2S_DAC_CHANNEL_LEFT_EN,
@@ -88,10 +158,11 @@ def _set_stream_limits(config):
             max_sample_rate=48000,
         )(config)
     else:
-        # Secondary mode has unmodifiable max bits per sample and min/max sample rates
+        # Secondary mode has unmodifiable min/max sample rates. Any stream bit depth is converted to the slot width
+        # inline by the speaker task, so bit depth is not restricted.
         audio.set_stream_limits(
             min_bits_per_sample=8,
-            max_bits_per_sample=config.get(CONF_BITS_PER_SAMPLE),
+            max_bits_per_sample=32,
             min_channels=1,
             max_channels=2,
             min_sample_rate=config.get(CONF_SAMPLE_RATE),
@@ -100,6 +171,32 @@ def _set_stream_limits(config):
 
     return config
 
+def _validate_watermarks(config):
+    # The task stops waiting once the ring buffer is full, so a watermark at or above its size would never be reached
+    for key in (CONF_START_WATERMARK, CONF_RESUME_WATERMARK):
+        if config[key] >= config[CONF_BUFFER_DURATION]:
+            raise cv.Invalid(f"{key} must be shorter than {CONF_BUFFER_DURATION}")
+    return config
+
+def _validate_task_profiling(config):
+    if not config[CONF_TASK_PROFILING]:
+        for key in (CONF_DMA_MARGIN_SENSOR, CONF_TASK_LOAD_SENSOR):
+            if key in config:
+                raise cv.Invalid(f"{key} requires {CONF_TASK_PROFILING} to be enabled")
+    return config
+
+
+def _validate_narrow_dma_data(config):
+    if not config[CONF_NARROW_DMA_DATA]:
+        return config
+    if config[CONF_BITS_PER_SAMPLE] not in (24, 32):
+        raise cv.Invalid(f"{CONF_NARROW_DMA_DATA} requires 24 or 32 bits per sample slots")
+    if esp32.get_esp32_variant() == esp32.const.VARIANT_ESP32:
+        # The ESP32 misbehaves with slots wider than the data; see I2SAudioBase::get_std_slot_cfg()
+        raise cv.Invalid(f"{CONF_NARROW_DMA_DATA} is not supported on the ESP32")
+    return config
+
+
 def _validate_esp32_variant(config):
     if config[CONF_DAC_TYPE] != "internal":
         return config
@@ -128,6 +225,52 @@ BASE_SCHEMA = (
                 cv.positive_time_period_milliseconds,
                 cv.one_of(CONF_NEVER, lower=True),
             ),
+            cv.Optional(CONF_DIRECT_DMA_WRITE, default=False): cv.boolean,
+            cv.Optional(CONF_SEAMLESS_UNDERFLOW, default=False): cv.boolean,
+            cv.Optional(CONF_SYNC_MODE, default=False): cv.boolean,
+            cv.Optional(
+                CONF_START_WATERMARK, default="0ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(
+                CONF_RESUME_WATERMARK, default="0ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ADAPTIVE_WATERMARK, default=False): cv.boolean,
+            cv.Optional(CONF_WARM_STANDBY, default=False): cv.boolean,
+            # Ignored on a port shared with a microphone, whose RX channel must keep the full slot data width
+            cv.Optional(CONF_NARROW_DMA_DATA, default=False): cv.boolean,
+            cv.Optional(CONF_EQUALIZER): cv.ensure_list(BIQUAD_SCHEMA),
+            cv.Optional(CONF_LIMITER): LIMITER_SCHEMA,
+            cv.Optional(CONF_WATERMARK_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_UNDERFLOW_RATE_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_UNDERFLOWS_PER_MINUTE,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_TIME_TO_FIRST_SAMPLE_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_TASK_PROFILING, default=False): cv.boolean,
+            cv.Optional(CONF_DMA_MARGIN_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_TASK_LOAD_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -156,6 +299,9 @@ CONFIG_SCHEMA = cv.All(
         key=CONF_DAC_TYPE,
     ),
     _validate_esp32_variant,
+    _validate_watermarks,
+    _validate_task_profiling,
+    _validate_narrow_dma_data,
     _set_num_channels_from_config,
     _set_stream_limits,
     validate_mclk_divisible_by_3
@@ -190,3 +336,66 @@ async def to_code(config):
     if config[CONF_TIMEOUT] != CONF_NEVER:
         cg.add(var.set_timeout(config[CONF_TIMEOUT]))
     cg.add(var.set_buffer_duration(config[CONF_BUFFER_DURATION]))
+    cg.add(var.set_direct_dma_write(config[CONF_DIRECT_DMA_WRITE]))
+    cg.add(var.set_seamless_underflow(config[CONF_SEAMLESS_UNDERFLOW]))
+    cg.add(var.set_sync_mode(config[CONF_SYNC_MODE]))
+    cg.add(var.set_start_watermark(config[CONF_START_WATERMARK]))
+    cg.add(var.set_resume_watermark(config[CONF_RESUME_WATERMARK]))
+    cg.add(var.set_adaptive_watermark(config[CONF_ADAPTIVE_WATERMARK]))
+    cg.add(var.set_warm_standby(config[CONF_WARM_STANDBY]))
+    cg.add(var.set_narrow_dma_data(config[CONF_NARROW_DMA_DATA]))
+
+    for biquad in config.get(CONF_EQUALIZER, []):
+        cg.add(
+            var.add_biquad(
+                biquad[CONF_TYPE], biquad[CONF_FREQUENCY], biquad[CONF_GAIN], biquad[CONF_Q]
+            )
+        )
+    if limiter := config.get(CONF_LIMITER):
+        cg.add(
+            var.set_limiter(
+                limiter[CONF_THRESHOLD], limiter[CONF_LOOK_AHEAD], limiter[CONF_RELEASE]
+            )
+        )
+
+    if conf := config.get(CONF_WATERMARK_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_watermark_sensor(sens))
+    if conf := config.get(CONF_UNDERFLOW_RATE_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_underflow_rate_sensor(sens))
+    if conf := config.get(CONF_TIME_TO_FIRST_SAMPLE_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_time_to_first_sample_sensor(sens))
+
+    if config[CONF_TASK_PROFILING]:
+        # Compiled out entirely unless requested; the timing hooks in the speaker task are empty without it
+        cg.add_define("USE_I2S_AUDIO_SPEAKER_PROFILING")
+    if conf := config.get(CONF_DMA_MARGIN_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_dma_margin_sensor(sens))
+    if conf := config.get(CONF_TASK_LOAD_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_task_load_sensor(sens))
+
+
+@register_addressable_effect(
+    "i2s_audio_reactive",
+    AudioReactiveLightEffect,
+    "Audio Reactive",
+    {
+        cv.Required(CONF_SPEAKERS): cv.ensure_list(cv.use_id(I2SAudioSpeakerBase)),
+        cv.Optional(
+            CONF_UPDATE_INTERVAL, default="16ms"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_DECAY, default="300ms"): cv.positive_time_period_milliseconds,
+    },
+)
+async def audio_reactive_effect_to_code(config, effect_id):
+    var = cg.new_Pvariable(effect_id, config[CONF_NAME])
+    for speaker_id in config[CONF_SPEAKERS]:
+        spkr = await cg.get_variable(speaker_id)
+        cg.add(var.add_speaker(spkr))
+    cg.add(var.set_update_interval(config[CONF_UPDATE_INTERVAL]))
+    cg.add(var.set_decay(config[CONF_DECAY]))
+    return var
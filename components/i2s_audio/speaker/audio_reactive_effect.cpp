@@ -0,0 +1,80 @@
+#include "audio_reactive_effect.h"
+
+#if defined(USE_ESP32) && defined(USE_LIGHT)
+
+#include "esphome/core/hal.h"
+
+#include <esp_timer.h>
+
+#include <algorithm>
+
+namespace esphome::i2s_audio {
+
+// A snapshot older than this belongs to a stream that has stopped, so its bands are treated as silent
+static constexpr int64_t STALE_SNAPSHOT_US = 100000;
+
+void AudioReactiveLightEffect::init() {
+  for (I2SAudioSpeakerBase *speaker : this->speakers_) {
+    BandEnergyAnalyzer *analyzer = speaker->get_band_energy_analyzer();
+    if (analyzer != nullptr) {
+      this->analyzers_.push_back(analyzer);
+    }
+  }
+}
+
+void AudioReactiveLightEffect::start() {
+  for (BandEnergyAnalyzer *analyzer : this->analyzers_) {
+    analyzer->acquire();
+  }
+  std::fill(std::begin(this->levels_), std::end(this->levels_), 0.0f);
+  this->last_run_ms_ = millis();
+}
+
+void AudioReactiveLightEffect::stop() {
+  for (BandEnergyAnalyzer *analyzer : this->analyzers_) {
+    analyzer->release();
+  }
+  AddressableLightEffect::stop();
+}
+
+void AudioReactiveLightEffect::apply(light::AddressableLight &it, const Color &current_color) {
+  const uint32_t now = millis();
+  const uint32_t elapsed_ms = now - this->last_run_ms_;
+  if (elapsed_ms < this->update_interval_ms_) {
+    return;
+  }
+  this->last_run_ms_ = now;
+
+  // Follow whichever speaker's audio is being heard most recently
+  const int64_t now_us = esp_timer_get_time();
+  BandEnergySnapshot newest;
+  bool heard = false;
+  for (const BandEnergyAnalyzer *analyzer : this->analyzers_) {
+    BandEnergySnapshot snapshot;
+    if (analyzer->read(now_us, snapshot) && (now_us - snapshot.presentation_us < STALE_SNAPSHOT_US) &&
+        (!heard || (snapshot.presentation_us > newest.presentation_us))) {
+      newest = snapshot;
+      heard = true;
+    }
+  }
+
+  follow_band_levels(this->levels_, heard ? &newest : nullptr,
+                     static_cast<float>(elapsed_ms) / std::max<uint32_t>(1, this->decay_ms_));
+
+  // LED 0 shows the lowest band; walking around the ring either way reaches the highest band opposite it
+  const int32_t size = it.size();
+  const float half = std::max(1.0f, size / 2.0f);
+  for (int32_t i = 0; i < size; ++i) {
+    const float distance = std::min(i, size - i) / half;
+    const float position = distance * (BandEnergySnapshot::NUM_BANDS - 1);
+    const size_t lower = std::min<size_t>(static_cast<size_t>(position), BandEnergySnapshot::NUM_BANDS - 2);
+    const float fraction = std::min(position - lower, 1.0f);
+    const float level = this->levels_[lower] + (this->levels_[lower + 1] - this->levels_[lower]) * fraction;
+    it[i] = current_color * static_cast<uint8_t>(level * 255.0f + 0.5f);
+  }
+  it.schedule_show();
+}
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32 && USE_LIGHT
@@ -0,0 +1,45 @@
+#pragma once
+
+#if defined(USE_ESP32) && defined(USE_LIGHT)
+
+#include "band_energy.h"
+#include "i2s_audio_speaker.h"
+
+#include "esphome/components/light/addressable_light_effect.h"
+
+#include <vector>
+
+namespace esphome::i2s_audio {
+
+/// @brief Addressable light effect that renders the band energies of one or more I2S speakers at up to the light's
+/// refresh rate. The lowest band lights the first LED and the highest the LED opposite it, mirrored on both sides,
+/// so a ring shows the spectrum as a symmetric arc in the light's current color. Levels rise at once and fall back
+/// over the decay time. Reading the energies never touches the audio path; the speakers only analyze their output
+/// while the effect runs.
+class AudioReactiveLightEffect : public light::AddressableLightEffect {
+ public:
+  explicit AudioReactiveLightEffect(const char *name) : AddressableLightEffect(name) {}
+
+  /// @brief Adds a speaker to follow. With several, e.g. behind a router, whichever is playing drives the effect.
+  void add_speaker(I2SAudioSpeakerBase *speaker) { this->speakers_.push_back(speaker); }
+  void set_update_interval(uint32_t update_interval_ms) { this->update_interval_ms_ = update_interval_ms; }
+  /// @brief Time a band takes to fall from full scale to dark once its audio stops.
+  void set_decay(uint32_t decay_ms) { this->decay_ms_ = decay_ms; }
+
+  void init() override;
+  void start() override;
+  void stop() override;
+  void apply(light::AddressableLight &it, const Color &current_color) override;
+
+ protected:
+  std::vector<I2SAudioSpeakerBase *> speakers_;
+  std::vector<BandEnergyAnalyzer *> analyzers_;
+  uint32_t update_interval_ms_{16};
+  uint32_t decay_ms_{300};
+  uint32_t last_run_ms_{0};
+  float levels_[BandEnergySnapshot::NUM_BANDS]{};  // displayed level of each band, 0 to 1
+};
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32 && USE_LIGHT
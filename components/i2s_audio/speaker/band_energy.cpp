@@ -0,0 +1,153 @@
+#include "band_energy.h"
+
+#ifdef USE_ESP32
+
+#include "i2s_audio_speaker_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome::i2s_audio {
+
+// The bands only need to reach the upper mids, so the audio is decimated to about this rate before filtering
+static constexpr uint32_t ANALYSIS_SAMPLE_RATE = 12000;
+static constexpr float LOWEST_BAND_HZ = 80.0f;
+static constexpr float HIGHEST_BAND_HZ = 5000.0f;
+// Levels cover this many decibels below full scale
+static constexpr float LEVEL_RANGE_DB = 60.0f;
+// Filtered Q31 samples are squared at Q15, so a full-scale square is 2^30
+static constexpr int ENERGY_SHIFT = 16;
+static constexpr float FULL_SCALE_ENERGY = 1073741824.0f;
+
+void BandEnergyAnalyzer::configure_(const audio::AudioStreamInfo &stream_info) {
+  this->stream_info_ = stream_info;
+  this->bytes_per_sample_ = stream_info.samples_to_bytes(1);
+  this->decimation_ = std::max<uint32_t>(1, stream_info.get_sample_rate() / ANALYSIS_SAMPLE_RATE);
+  const uint32_t analysis_rate = stream_info.get_sample_rate() / this->decimation_;
+
+  // Log-spaced centres; the Q makes neighbouring bands meet at their geometric midpoints
+  const float highest = std::min(HIGHEST_BAND_HZ, 0.4f * analysis_rate);
+  const float ratio = std::pow(highest / LOWEST_BAND_HZ, 1.0f / (BandEnergySnapshot::NUM_BANDS - 1));
+  const float q = std::sqrt(ratio) / (ratio - 1.0f);
+  this->configured_ = true;
+  float frequency = LOWEST_BAND_HZ;
+  for (Biquad &band : this->bands_) {
+    band.type = BiquadType::BAND_PASS;
+    band.frequency = frequency;
+    band.q = q;
+    this->configured_ &= band.configure(analysis_rate);
+    frequency *= ratio;
+  }
+
+  this->decimation_count_ = 0;
+  this->decimation_sum_ = 0;
+  this->scratch_length_ = 0;
+  std::fill(std::begin(this->energy_), std::end(this->energy_), 0);
+  this->energy_samples_ = 0;
+}
+
+template<size_t Bytes> void BandEnergyAnalyzer::accumulate_(const uint8_t *data, size_t frames) {
+  const uint8_t channels = this->stream_info_.get_channels();
+  // Halving each sample before the sum keeps a full-scale stereo mix inside Q31
+  const int shift = (channels > 1) ? 1 : 0;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+      this->decimation_sum_ += kernels::load_q31<Bytes>(data) >> shift;
+      data += Bytes;
+    }
+    if (++this->decimation_count_ == this->decimation_) {
+      this->scratch_[this->scratch_length_++] = static_cast<int32_t>(this->decimation_sum_ / this->decimation_);
+      this->decimation_count_ = 0;
+      this->decimation_sum_ = 0;
+      if (this->scratch_length_ == SCRATCH_SAMPLES) {
+        this->filter_scratch_();
+      }
+    }
+  }
+}
+
+void BandEnergyAnalyzer::filter_scratch_() {
+  for (size_t band = 0; band < BandEnergySnapshot::NUM_BANDS; ++band) {
+    std::copy(this->scratch_, this->scratch_ + this->scratch_length_, this->filtered_);
+    this->bands_[band].process(this->filtered_, this->scratch_length_, 1);
+    uint64_t energy = 0;
+    for (size_t i = 0; i < this->scratch_length_; ++i) {
+      const int32_t y = this->filtered_[i] >> ENERGY_SHIFT;
+      energy += static_cast<uint64_t>(static_cast<int64_t>(y) * y);
+    }
+    this->energy_[band] += energy;
+  }
+  this->energy_samples_ += this->scratch_length_;
+  this->scratch_length_ = 0;
+}
+
+void BandEnergyAnalyzer::analyze(const uint8_t *data, size_t bytes, int64_t presentation_us,
+                                 const audio::AudioStreamInfo &stream_info) {
+  if (!this->configured_ || (stream_info != this->stream_info_)) {
+    this->configure_(stream_info);
+    if (!this->configured_) {
+      return;
+    }
+  }
+
+  const size_t frames = this->stream_info_.bytes_to_frames(bytes);
+  switch (this->bytes_per_sample_) {
+    case 2:
+      this->accumulate_<2>(data, frames);
+      break;
+    case 3:
+      this->accumulate_<3>(data, frames);
+      break;
+    case 4:
+      this->accumulate_<4>(data, frames);
+      break;
+    default:
+      return;
+  }
+  if (this->scratch_length_ > 0) {
+    this->filter_scratch_();
+  }
+  if (this->energy_samples_ > 0) {
+    this->publish_(presentation_us);
+  }
+}
+
+void BandEnergyAnalyzer::publish_(int64_t presentation_us) {
+  const uint32_t head = this->head_.load(std::memory_order_relaxed);
+  // Order the previous head update before this slot is overwritten, so a reader that sees a torn slot also sees that
+  // the ring has lapped it
+  std::atomic_thread_fence(std::memory_order_release);
+  BandEnergySnapshot &snapshot = this->snapshots_[head & (CAPACITY - 1)];
+  snapshot.presentation_us = presentation_us;
+  for (size_t band = 0; band < BandEnergySnapshot::NUM_BANDS; ++band) {
+    const float mean_square = static_cast<float>(this->energy_[band]) / this->energy_samples_;
+    const float db = 10.0f * std::log10(std::max(mean_square, 1.0f) / FULL_SCALE_ENERGY);
+    const float level = std::clamp((db + LEVEL_RANGE_DB) / LEVEL_RANGE_DB, 0.0f, 1.0f);
+    snapshot.levels[band] = static_cast<uint8_t>(level * 255.0f + 0.5f);
+    this->energy_[band] = 0;
+  }
+  this->energy_samples_ = 0;
+  this->head_.store(head + 1, std::memory_order_release);
+}
+
+bool BandEnergyAnalyzer::read(int64_t now_us, BandEnergySnapshot &snapshot) const {
+  const uint32_t head = this->head_.load(std::memory_order_acquire);
+  const uint32_t available = std::min<uint32_t>(head, CAPACITY - 1);
+  // Newest first; the slot the speaker task may be writing is never read
+  for (uint32_t age = 1; age <= available; ++age) {
+    const uint32_t sequence = head - age;
+    snapshot = this->snapshots_[sequence & (CAPACITY - 1)];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->head_.load(std::memory_order_relaxed) - sequence >= CAPACITY) {
+      return false;  // overwritten while it was copied; everything older is gone too
+    }
+    if (snapshot.presentation_us <= now_us) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
@@ -0,0 +1,94 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "i2s_audio_speaker_dsp.h"
+
+#include "esphome/components/audio/audio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome::i2s_audio {
+
+/// @brief Energy of one block of played audio in each analysis band.
+struct BandEnergySnapshot {
+  static constexpr size_t NUM_BANDS = 8;
+
+  int64_t presentation_us{0};    // esp_timer time at which the block's first frame is heard
+  uint8_t levels[NUM_BANDS]{};  // 0 at or below -60 dBFS, 255 at full scale; lowest band first
+};
+
+/// @brief Moves displayed band levels (0 to 1) towards a snapshot: a band rises at once to a louder level and otherwise
+/// falls by `fall`, so it drops from full scale to dark in 1 / `fall` steps once its audio stops.
+/// @param snapshot Levels being heard now, or nullptr for silence
+inline void follow_band_levels(float (&levels)[BandEnergySnapshot::NUM_BANDS], const BandEnergySnapshot *snapshot,
+                               float fall) {
+  for (size_t band = 0; band < BandEnergySnapshot::NUM_BANDS; ++band) {
+    const float level = (snapshot != nullptr) ? snapshot->levels[band] / 255.0f : 0.0f;
+    levels[band] = std::max(level, levels[band] - fall);
+  }
+}
+
+/// @brief Splits the audio the speaker hands to the DMA into eight log-spaced bands between 80 Hz and 5 kHz and
+/// publishes their energy once per block, for visualizations such as an audio-reactive LED effect. The speaker task
+/// mixes each block down to mono, decimates it to about 12 kHz, and runs it through a bank of Q31 band-pass biquads.
+/// Readers on any task pick the snapshot being heard right now from a small lock-free ring; the speaker never waits
+/// on them.
+class BandEnergyAnalyzer {
+ public:
+  static constexpr uint32_t CAPACITY = 16;  // power of two; covers the DMA queue's lead on playback
+
+  /// @brief Readers hold the analyzer active while they render. The speaker skips an inactive analyzer, so it costs
+  /// nothing while no effect is running.
+  void acquire() { this->users_.fetch_add(1, std::memory_order_relaxed); }
+  void release() { this->users_.fetch_sub(1, std::memory_order_relaxed); }
+  bool is_active() const { return this->users_.load(std::memory_order_relaxed) > 0; }
+
+  /// @brief Analyzes a block of DMA-format audio and publishes its band energies. Only called from the speaker task.
+  /// @param presentation_us esp_timer time at which the block's first frame is heard
+  void analyze(const uint8_t *data, size_t bytes, int64_t presentation_us, const audio::AudioStreamInfo &stream_info);
+
+  /// @brief Copies the newest snapshot that has started playing by `now_us`. Safe to call from any task.
+  /// @return False if no published block has been heard yet
+  bool read(int64_t now_us, BandEnergySnapshot &snapshot) const;
+
+ protected:
+  static constexpr size_t SCRATCH_SAMPLES = 64;
+
+  /// @brief Designs the band filters for a new stream format and clears all history.
+  void configure_(const audio::AudioStreamInfo &stream_info);
+
+  /// @brief Mixes and decimates `frames` frames into the scratch buffer, filtering it whenever it fills.
+  template<size_t Bytes> void accumulate_(const uint8_t *data, size_t frames);
+
+  /// @brief Runs the decimated samples in the scratch buffer through every band and adds up their energy.
+  void filter_scratch_();
+
+  void publish_(int64_t presentation_us);
+
+  // Owned by the speaker task
+  audio::AudioStreamInfo stream_info_;  // format the filters were designed for
+  bool configured_{false};
+  uint8_t bytes_per_sample_{0};
+  uint32_t decimation_{1};
+  uint32_t decimation_count_{0};
+  int64_t decimation_sum_{0};
+  int32_t scratch_[SCRATCH_SAMPLES];
+  int32_t filtered_[SCRATCH_SAMPLES];
+  size_t scratch_length_{0};
+  Biquad bands_[BandEnergySnapshot::NUM_BANDS];
+  uint64_t energy_[BandEnergySnapshot::NUM_BANDS]{};
+  uint32_t energy_samples_{0};
+
+  // Written by the speaker task, read by any task
+  BandEnergySnapshot snapshots_[CAPACITY];
+  std::atomic<uint32_t> head_{0};  // sequence number of the next snapshot the speaker task writes
+  std::atomic<uint8_t> users_{0};
+};
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
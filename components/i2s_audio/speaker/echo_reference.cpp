@@ -0,0 +1,116 @@
+#include "echo_reference.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/helpers.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esphome::i2s_audio {
+
+std::unique_ptr<EchoReferenceRing> EchoReferenceRing::create(size_t capacity_bytes) {
+  std::unique_ptr<EchoReferenceRing> ring(new EchoReferenceRing());
+  // A power of two keeps positions consistent when the free-running counters wrap, and every block starts 8-byte
+  // aligned
+  ring->capacity_ = 64;
+  while (ring->capacity_ < capacity_bytes) {
+    ring->capacity_ *= 2;
+  }
+  RAMAllocator<uint8_t> allocator;
+  ring->storage_ = allocator.allocate(ring->capacity_);
+  if (ring->storage_ == nullptr) {
+    return nullptr;
+  }
+  return ring;
+}
+
+EchoReferenceRing::~EchoReferenceRing() {
+  if (this->storage_ != nullptr) {
+    RAMAllocator<uint8_t> allocator;
+    allocator.deallocate(this->storage_, this->capacity_);
+  }
+}
+
+void EchoReferenceRing::write(const uint8_t *data, size_t bytes, int64_t presentation_us,
+                              const audio::AudioStreamInfo &stream_info) {
+  const size_t block_size = block_size_(bytes);
+  size_t head = this->head_.load(std::memory_order_relaxed);
+  const size_t position = head % this->capacity_;
+  const size_t to_end = this->capacity_ - position;
+  // A block never wraps; the space left at the end is skipped instead
+  const size_t needed = (block_size > to_end) ? to_end + block_size : block_size;
+
+  if (needed > this->capacity_ - (head - this->tail_.load(std::memory_order_acquire))) {
+    this->dropped_blocks_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  if (block_size > to_end) {
+    if (to_end >= HEADER_SIZE) {
+      BlockHeader marker{};
+      marker.bytes = WRAP_MARKER;
+      std::memcpy(this->storage_ + position, &marker, HEADER_SIZE);
+    }
+    head += to_end;
+  }
+
+  BlockHeader header{};
+  header.presentation_us = presentation_us;
+  header.bytes = bytes;
+  header.sample_rate = stream_info.get_sample_rate();
+  header.bits_per_sample = stream_info.get_bits_per_sample();
+  header.channels = stream_info.get_channels();
+  uint8_t *block = this->storage_ + head % this->capacity_;
+  std::memcpy(block, &header, HEADER_SIZE);
+  std::memcpy(block + HEADER_SIZE, data, bytes);
+  this->head_.store(head + block_size, std::memory_order_release);
+}
+
+size_t EchoReferenceRing::read(uint8_t *data, size_t max_bytes, int64_t &presentation_us) {
+  const size_t head = this->head_.load(std::memory_order_acquire);
+  size_t tail = this->tail_.load(std::memory_order_relaxed);
+
+  while (tail != head) {
+    const size_t position = tail % this->capacity_;
+    const size_t to_end = this->capacity_ - position;
+    BlockHeader header;
+    if (to_end >= HEADER_SIZE) {
+      std::memcpy(&header, this->storage_ + position, HEADER_SIZE);
+    }
+    if ((to_end < HEADER_SIZE) || (header.bytes == WRAP_MARKER)) {
+      tail += to_end;
+      continue;
+    }
+
+    this->read_stream_info_ =
+        audio::AudioStreamInfo(header.bits_per_sample, header.channels, header.sample_rate);
+    const size_t bytes_per_frame = this->read_stream_info_.frames_to_bytes(1);
+    const size_t remaining = header.bytes - header.consumed;
+    const size_t bytes = std::min(remaining, max_bytes - max_bytes % bytes_per_frame);
+    if (bytes == 0) {
+      break;
+    }
+
+    std::memcpy(data, this->storage_ + position + HEADER_SIZE + header.consumed, bytes);
+    presentation_us =
+        header.presentation_us + this->read_stream_info_.frames_to_microseconds(header.consumed / bytes_per_frame);
+
+    if (bytes == remaining) {
+      this->tail_.store(tail + block_size_(header.bytes), std::memory_order_release);
+    } else {
+      // The writer never touches an unreleased block, so the reader keeps its progress in the header
+      header.consumed += bytes;
+      std::memcpy(this->storage_ + position, &header, HEADER_SIZE);
+      this->tail_.store(tail, std::memory_order_release);
+    }
+    return bytes;
+  }
+
+  this->tail_.store(tail, std::memory_order_release);
+  return 0;
+}
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "esphome/components/audio/audio.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome::i2s_audio {
+
+/// @brief Lock-free single-producer, single-consumer ring of audio exactly as the speaker handed it to the DMA: after
+/// volume, the DSP chain, the ESP32 mono swap and conversion to the I2S slot width. The speaker task writes each block
+/// together with the time its first frame is heard; one subscriber, e.g. an echo canceller, reads them back. Blocks
+/// that do not fit are dropped whole and counted, so the speaker never waits on a slow subscriber.
+class EchoReferenceRing {
+ public:
+  /// @brief Allocates a ring holding at least `capacity_bytes` of audio and block headers, rounded up to a power of
+  /// two, preferring PSRAM.
+  /// @return nullptr if the allocation failed
+  static std::unique_ptr<EchoReferenceRing> create(size_t capacity_bytes);
+  ~EchoReferenceRing();
+
+  /// @brief Inactive rings are skipped by the speaker, so an idle subscriber costs no copies. Deactivating does not
+  /// discard audio already written.
+  void set_active(bool active) { this->active_.store(active, std::memory_order_relaxed); }
+  bool is_active() const { return this->active_.load(std::memory_order_relaxed); }
+
+  /// @brief Reads up to `max_bytes` of played audio from the oldest block, in whole frames. Only call from the
+  /// subscriber's task.
+  /// @param presentation_us Set to the esp_timer time at which the first returned frame was heard
+  /// @return Number of bytes read; 0 if the ring is empty
+  size_t read(uint8_t *data, size_t max_bytes, int64_t &presentation_us);
+
+  /// @brief Format of the audio most recently returned by read().
+  const audio::AudioStreamInfo &get_audio_stream_info() const { return this->read_stream_info_; }
+
+  /// @brief Number of blocks dropped because the ring was full, since the last call.
+  uint32_t take_dropped_blocks() { return this->dropped_blocks_.exchange(0, std::memory_order_relaxed); }
+
+  /// @brief Appends a block of played audio. Only called from the speaker task.
+  /// @param presentation_us esp_timer time at which the block's first frame is heard
+  void write(const uint8_t *data, size_t bytes, int64_t presentation_us, const audio::AudioStreamInfo &stream_info);
+
+ protected:
+  EchoReferenceRing() = default;
+
+  struct BlockHeader {
+    int64_t presentation_us;
+    uint32_t bytes;     // audio bytes in the block, or WRAP_MARKER
+    uint32_t consumed;  // bytes the reader has already taken from a partially read block
+    uint32_t sample_rate;
+    uint8_t bits_per_sample;
+    uint8_t channels;
+    uint16_t reserved;
+  };
+  static constexpr uint32_t WRAP_MARKER = UINT32_MAX;
+  static constexpr size_t HEADER_SIZE = sizeof(BlockHeader);
+
+  static size_t block_size_(size_t bytes) { return HEADER_SIZE + ((bytes + 7) & ~static_cast<size_t>(7)); }
+
+  uint8_t *storage_{nullptr};
+  size_t capacity_{0};
+  std::atomic<size_t> head_{0};  // bytes ever written, including wrap padding
+  std::atomic<size_t> tail_{0};  // bytes ever released by the reader
+  std::atomic<bool> active_{false};
+  std::atomic<uint32_t> dropped_blocks_{0};
+  audio::AudioStreamInfo read_stream_info_;
+};
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
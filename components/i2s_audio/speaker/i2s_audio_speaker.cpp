@@ -9,6 +9,11 @@
 
 #include "esp_timer.h"
 
+#include <sys/time.h>
+
+#include <algorithm>
+#include <new>
+
 // esp-audio-libs
 #include <gain.h>
 
@@ -20,6 +25,25 @@ static const char *const TAG = "i2s_audio.speaker";
 // Volumes in (0.0, 1.0) map linearly to a dB reduction in [-49.0, 0.0] dB.
 static constexpr float SOFTWARE_VOLUME_MIN_DB = -49.0f;
 
+// System time before 2020 means no time source has set the clock yet
+static constexpr time_t SYNC_MIN_VALID_EPOCH = 1577836800;
+
+// Adaptive watermark: a second underflow within this window means the source is burstier than the watermark allows for
+static constexpr uint32_t WATERMARK_UNDERFLOW_WINDOW_MS = 10000;
+static constexpr uint32_t WATERMARK_RAISE_STEP_MS = 30;
+// Each period without an underflow lowers the watermarks by one step back toward their configured values
+static constexpr uint32_t WATERMARK_STEADY_PERIOD_MS = 30000;
+static constexpr uint32_t WATERMARK_LOWER_STEP_MS = 10;
+// The raised watermark never exceeds this fraction of the buffer duration, so the ring buffer can always reach it
+static constexpr uint32_t WATERMARK_LIMIT_PERCENT = 75;
+
+static constexpr uint32_t SENSOR_PUBLISH_INTERVAL_MS = 10000;
+
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+static constexpr uint32_t PROFILE_REPORT_INTERVAL_MS = 10000;
+static const char *const PROFILE_PHASE_NAMES[PHASE_COUNT] = {"Drain", "Transfer", "Convert", "Write"};
+#endif
+
 void I2SAudioSpeakerBase::setup() {
   this->event_group_ = xEventGroupCreate();
   if (this->event_group_ == nullptr) {
@@ -28,6 +52,11 @@ void I2SAudioSpeakerBase::setup() {
     return;
   }
 
+  if (this->warm_standby_ && this->parent_->has_audio_in()) {
+    ESP_LOGW(TAG, "Warm standby is unavailable on a port shared with a microphone");
+    this->warm_standby_ = false;
+  }
+
   this->set_volume(this->volume_);
 }
 
@@ -40,6 +69,40 @@ void I2SAudioSpeakerBase::dump_config() {
   if (this->timeout_.has_value()) {
     ESP_LOGCONFIG(TAG, "  Timeout: %" PRIu32 " ms", this->timeout_.value());
   }
+  ESP_LOGCONFIG(TAG, "  Direct DMA write: %s", YESNO(this->direct_dma_write_));
+  ESP_LOGCONFIG(TAG, "  Seamless underflow: %s", YESNO(this->seamless_underflow_));
+  ESP_LOGCONFIG(TAG, "  Sync to system clock: %s", YESNO(this->sync_mode_));
+  ESP_LOGCONFIG(TAG, "  Warm standby: %s", YESNO(this->warm_standby_));
+  ESP_LOGCONFIG(TAG, "  Narrow DMA data: %s%s", YESNO(this->narrow_dma_data_),
+                (this->narrow_dma_data_ && this->parent_->has_audio_in()) ? " (unused, port shared with a microphone)"
+                                                                           : "");
+  ESP_LOGCONFIG(TAG,
+                "  Start watermark: %" PRIu32 " ms\n"
+                "  Resume watermark: %" PRIu32 " ms\n"
+                "  Adaptive watermark: %s",
+                this->start_watermark_ms_, this->resume_watermark_ms_, YESNO(this->adaptive_watermark_));
+  if (this->dsp_.get_biquad_count() > 0) {
+    ESP_LOGCONFIG(TAG, "  EQ biquads: %u", (unsigned) this->dsp_.get_biquad_count());
+  }
+  if (this->dsp_.is_limiter_enabled()) {
+    const PeakLimiter &limiter = this->dsp_.get_limiter();
+    ESP_LOGCONFIG(TAG,
+                  "  Limiter:\n"
+                  "    Threshold: %.1f dB\n"
+                  "    Look-ahead: %" PRIu32 " ms\n"
+                  "    Release: %" PRIu32 " ms",
+                  limiter.threshold_db, limiter.look_ahead_ms, limiter.release_ms);
+  }
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "Watermark", this->watermark_sensor_);
+  LOG_SENSOR("  ", "Underflow rate", this->underflow_rate_sensor_);
+  LOG_SENSOR("  ", "Time to first sample", this->time_to_first_sample_sensor_);
+  LOG_SENSOR("  ", "DMA margin", this->dma_margin_sensor_);
+  LOG_SENSOR("  ", "Task load", this->task_load_sensor_);
+#endif
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+  ESP_LOGCONFIG(TAG, "  Task profiling: enabled");
+#endif
 }
 
 void I2SAudioSpeakerBase::loop() {
@@ -55,20 +118,14 @@ void I2SAudioSpeakerBase::loop() {
   }
   if (event_group_bits & SpeakerEventGroupBits::TASK_STOPPING) {
     ESP_LOGV(TAG, "Stopping");
-    // Lockstep-breaking error bits are latched by the task and cleared along with all other bits
-    // when TASK_STOPPED is processed; log them here, exactly once, as the task winds down.
-    if (event_group_bits & SpeakerEventGroupBits::ERR_DROPPED_EVENT) {
-      ESP_LOGE(TAG, "ISR event queue overflow, restarting speaker task to recover timestamp sync");
-    }
-    if (event_group_bits & SpeakerEventGroupBits::ERR_PARTIAL_WRITE) {
-      ESP_LOGE(TAG, "Partial DMA write broke buffer alignment, restarting speaker task");
-    }
-    if (event_group_bits & SpeakerEventGroupBits::ERR_LOCKSTEP_DESYNC) {
-      ESP_LOGE(TAG, "Event/record queues desynced, restarting speaker task");
-    }
     xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::TASK_STOPPING);
     this->state_ = speaker::STATE_STOPPING;
   }
+  if (event_group_bits & SpeakerEventGroupBits::TASK_STANDBY) {
+    ESP_LOGV(TAG, "Standing by");
+    xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::TASK_STANDBY);
+    this->state_ = speaker::STATE_STOPPED;
+  }
   if (event_group_bits & SpeakerEventGroupBits::TASK_STOPPED) {
     if (this->speaker_task_handle_ != nullptr) {
       vTaskDelete(this->speaker_task_handle_);
@@ -88,11 +145,68 @@ void I2SAudioSpeakerBase::loop() {
     xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::ERR_ESP_NO_MEM);
   }
 
+  const uint32_t boundary_head = this->stream_boundary_head_.load(std::memory_order_acquire);
+  if (boundary_head - this->stream_boundary_tail_ > STREAM_BOUNDARY_SLOTS) {
+    this->stream_boundary_tail_ = boundary_head - STREAM_BOUNDARY_SLOTS;
+  }
+  while (this->stream_boundary_tail_ != boundary_head) {
+    const StreamBoundary &boundary = this->stream_boundaries_[this->stream_boundary_tail_ % STREAM_BOUNDARY_SLOTS];
+    ESP_LOGD(TAG, "Chained stream starts at frame %" PRIu64, boundary.frame);
+    this->stream_boundary_callback_.call(boundary.frame, boundary.presentation_us);
+    ++this->stream_boundary_tail_;
+  }
+
+  const uint32_t first_sample_latency_us = this->first_sample_latency_us_.exchange(0, std::memory_order_relaxed);
+  if (first_sample_latency_us > 0) {
+    ESP_LOGD(TAG, "Time to first sample: %.1f ms", first_sample_latency_us / 1000.0f);
+#ifdef USE_SENSOR
+    if (this->time_to_first_sample_sensor_ != nullptr) {
+      this->time_to_first_sample_sensor_->publish_state(first_sample_latency_us / 1000.0f);
+    }
+#endif
+  }
+
+  const uint32_t missed_dma_events = this->missed_dma_events_.exchange(0, std::memory_order_relaxed);
+  if (missed_dma_events > 0) {
+    ESP_LOGW(TAG, "Speaker task fell behind and missed %" PRIu32 " DMA completions", missed_dma_events);
+  }
+
+#ifdef USE_SENSOR
+  const uint32_t now = millis();
+  const uint32_t publish_elapsed_ms = now - this->last_sensor_publish_ms_;
+  if (publish_elapsed_ms >= SENSOR_PUBLISH_INTERVAL_MS) {
+    this->last_sensor_publish_ms_ = now;
+    const uint32_t underflows = this->underflow_count_.exchange(0, std::memory_order_relaxed);
+    if (this->underflow_rate_sensor_ != nullptr) {
+      this->underflow_rate_sensor_->publish_state(underflows * 60000.0f / publish_elapsed_ms);
+    }
+    if (this->watermark_sensor_ != nullptr) {
+      this->watermark_sensor_->publish_state(this->resume_watermark_ms_ + this->watermark_offset_ms_(now));
+    }
+  }
+#endif
+
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+  const uint32_t profile_elapsed_ms = millis() - this->last_profile_report_ms_;
+  if (profile_elapsed_ms >= PROFILE_REPORT_INTERVAL_MS) {
+    this->last_profile_report_ms_ += profile_elapsed_ms;
+    if (this->state_ == speaker::STATE_RUNNING) {
+      this->report_profile_(profile_elapsed_ms);
+    }
+  }
+#endif
+
   // Spawn task when COMMAND_START is received and speaker is starting
   if ((event_group_bits & SpeakerEventGroupBits::COMMAND_START) && (this->state_ == speaker::STATE_STARTING)) {
     xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::COMMAND_START);
 
-    if (this->start_i2s_driver(this->audio_stream_info_) != ESP_OK) {
+    if (this->speaker_task_handle_ != nullptr) {
+      // The task is parked in warm standby with its channel and buffers; drop any stop request that raced its parking
+      xEventGroupClearBits(this->event_group_,
+                           SpeakerEventGroupBits::COMMAND_STOP | SpeakerEventGroupBits::COMMAND_STOP_GRACEFULLY);
+      this->standby_wake_.store(true, std::memory_order_release);
+      xTaskNotifyGive(this->speaker_task_handle_);
+    } else if (this->start_i2s_driver(this->audio_stream_info_) != ESP_OK) {
       ESP_LOGE(TAG, "Driver failed to start; retrying in 1 second");
       this->state_ = speaker::STATE_STOPPED;
       this->status_momentary_error("driver-failure", 1000);
@@ -110,6 +224,44 @@ void I2SAudioSpeakerBase::loop() {
   }
 }
 
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+void I2SAudioSpeakerBase::report_profile_(uint32_t elapsed_ms) {
+  uint64_t busy_us = 0;
+  for (uint8_t phase = 0; phase < PHASE_COUNT; ++phase) {
+    const TimingHistogram &histogram = this->profiler_.get_phase(static_cast<SpeakerTaskPhase>(phase));
+    if (histogram.samples == 0) {
+      continue;
+    }
+    ESP_LOGD(TAG,
+             "%s: %" PRIu32 " runs, mean %" PRIu32 " us, p50 %" PRIu32 " us, p99 %" PRIu32 " us, max %" PRIu32 " us",
+             PROFILE_PHASE_NAMES[phase], histogram.samples,
+             static_cast<uint32_t>(histogram.total_us / histogram.samples), histogram.percentile_us(50),
+             histogram.percentile_us(99), histogram.max_us);
+    // Transfer and write include time blocked waiting for audio or DMA space, so only drain and convert count as load
+    if ((phase == PHASE_DRAIN) || (phase == PHASE_CONVERT)) {
+      busy_us += histogram.total_us;
+    }
+  }
+
+  const TimingHistogram &margin = this->profiler_.get_margin();
+  if (margin.samples > 0) {
+    ESP_LOGD(TAG, "DMA margin: min %" PRIu32 " us, p1 %" PRIu32 " us, missed %" PRIu32 " of %" PRIu32, margin.min_us,
+             margin.percentile_us(1), margin.counts[0], margin.samples);
+  }
+
+#ifdef USE_SENSOR
+  if ((this->dma_margin_sensor_ != nullptr) && (margin.samples > 0)) {
+    this->dma_margin_sensor_->publish_state(margin.min_us / 1000.0f);
+  }
+  if (this->task_load_sensor_ != nullptr) {
+    this->task_load_sensor_->publish_state(busy_us / (elapsed_ms * 10.0f));
+  }
+#endif
+
+  this->profiler_.request_reset();
+}
+#endif  // USE_I2S_AUDIO_SPEAKER_PROFILING
+
 void I2SAudioSpeakerBase::set_volume(float volume) {
   this->volume_ = volume;
 #ifdef USE_AUDIO_DAC
@@ -149,6 +301,14 @@ void I2SAudioSpeakerBase::set_mute_state(bool mute_state) {
   }
 }
 
+void I2SAudioSpeakerBase::duck(float gain, uint32_t ramp_ms) {
+  gain = std::clamp(gain, 0.0f, 1.0f);
+  const int32_t q31_gain = (gain >= 1.0f) ? INT32_MAX : static_cast<int32_t>(gain * 2147483648.0f);
+  this->duck_request_gain_.store(q31_gain, std::memory_order_relaxed);
+  this->duck_request_ramp_ms_.store(ramp_ms, std::memory_order_relaxed);
+  this->duck_requests_.fetch_add(1, std::memory_order_release);
+}
+
 size_t I2SAudioSpeakerBase::play(const uint8_t *data, size_t length, TickType_t ticks_to_wait) {
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Setup failed; cannot play audio");
@@ -160,22 +320,236 @@ size_t I2SAudioSpeakerBase::play(const uint8_t *data, size_t length, TickType_t
   }
 
   size_t bytes_written = 0;
-  if (this->state_ == speaker::STATE_RUNNING) {
-    std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = this->audio_ring_buffer_.lock();
-    if (temp_ring_buffer != nullptr) {
-      bytes_written = temp_ring_buffer->write_without_replacement((void *) data, length, ticks_to_wait);
+  std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer;
+  {
+    // Audio in a new format waits until the task has reached the end of the current stream and switched over. The
+    // task only switches while the formats differ, so the ring can't be reframed between this check and the write.
+    LockGuard lock(this->stream_lock_);
+    if ((this->state_ == speaker::STATE_RUNNING) && (this->audio_stream_info_ == this->current_stream_info_)) {
+      temp_ring_buffer = this->audio_ring_buffer_.lock();
     }
   }
+  if (temp_ring_buffer != nullptr) {
+    bytes_written = temp_ring_buffer->write(data, length, ticks_to_wait);
+    this->ring_bytes_written_.fetch_add(bytes_written, std::memory_order_relaxed);
+  }
 
   return bytes_written;
 }
 
+size_t I2SAudioSpeakerBase::play_at(const uint8_t *data, size_t length, int64_t presentation_time_us) {
+  // Publish the schedule before the audio so the task can never consume the clip's first frame without seeing it
+  this->scheduled_start_byte_.store(this->ring_bytes_written_.load(std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+  this->scheduled_start_us_.store(presentation_time_us, std::memory_order_release);
+
+  const size_t bytes_written = this->play(data, length, 0);
+  if (bytes_written == 0) {
+    int64_t expected = presentation_time_us;
+    this->scheduled_start_us_.compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+  }
+  return bytes_written;
+}
+
+EchoReferenceRing *I2SAudioSpeakerBase::add_echo_reference_subscriber(size_t capacity_bytes) {
+  if (this->echo_reference_count_ >= MAX_ECHO_REFERENCE_SUBSCRIBERS) {
+    ESP_LOGE(TAG, "Too many echo reference subscribers");
+    return nullptr;
+  }
+  std::unique_ptr<EchoReferenceRing> ring = EchoReferenceRing::create(capacity_bytes);
+  if (ring == nullptr) {
+    ESP_LOGE(TAG, "Failed to allocate echo reference ring");
+    return nullptr;
+  }
+  this->echo_references_[this->echo_reference_count_] = std::move(ring);
+  return this->echo_references_[this->echo_reference_count_++].get();
+}
+
+BandEnergyAnalyzer *I2SAudioSpeakerBase::get_band_energy_analyzer() {
+  if (this->band_energy_ == nullptr) {
+    this->band_energy_.reset(new (std::nothrow) BandEnergyAnalyzer());
+    if (this->band_energy_ == nullptr) {
+      ESP_LOGE(TAG, "Failed to allocate band energy analyzer");
+    }
+  }
+  return this->band_energy_.get();
+}
+
 bool I2SAudioSpeakerBase::has_buffered_data() const {
-  if (this->audio_ring_buffer_.use_count() > 0) {
-    std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = this->audio_ring_buffer_.lock();
-    return temp_ring_buffer->available() > 0;
+  std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer;
+  {
+    LockGuard lock(this->stream_lock_);
+    temp_ring_buffer = this->audio_ring_buffer_.lock();
+  }
+  return (temp_ring_buffer != nullptr) && (temp_ring_buffer->available() > 0);
+}
+
+uint32_t I2SAudioSpeakerBase::get_output_latency_us() const {
+  if (this->state_ != speaker::STATE_RUNNING) {
+    return 0;
+  }
+
+  const int64_t now = esp_timer_get_time();
+  const int64_t dma_free_at =
+      std::max(now, std::max(this->dma_queue_end_us_.load(std::memory_order_relaxed),
+                             this->next_dma_slot_us_.load(std::memory_order_relaxed)));
+
+  uint32_t buffered_frames = this->staged_frames_.load(std::memory_order_relaxed) + this->dsp_.get_latency_frames();
+  std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer;
+  audio::AudioStreamInfo stream_info;
+  {
+    LockGuard lock(this->stream_lock_);
+    temp_ring_buffer = this->audio_ring_buffer_.lock();
+    stream_info = this->current_stream_info_;
+  }
+  if (temp_ring_buffer != nullptr) {
+    buffered_frames += stream_info.bytes_to_frames(temp_ring_buffer->available());
+  }
+
+  return static_cast<uint32_t>(dma_free_at - now) + stream_info.frames_to_microseconds(buffered_frames);
+}
+
+int64_t I2SAudioSpeakerBase::get_next_presentation_time_us() const {
+  return esp_timer_get_time() + this->get_output_latency_us();
+}
+
+uint32_t I2SAudioSpeakerBase::watermark_ms_(bool resuming) const {
+  const uint32_t watermark_ms = resuming ? this->resume_watermark_ms_ : this->start_watermark_ms_;
+  return watermark_ms + this->watermark_offset_ms_(millis());
+}
+
+uint32_t I2SAudioSpeakerBase::watermark_offset_ms_(uint32_t now) const {
+  const uint32_t raised_ms = this->watermark_raised_ms_.load(std::memory_order_relaxed);
+  if (raised_ms == 0) {
+    return 0;
+  }
+  const uint32_t steady_periods =
+      (now - this->last_underflow_ms_.load(std::memory_order_relaxed)) / WATERMARK_STEADY_PERIOD_MS;
+  const uint32_t lowered_ms = std::min(steady_periods, raised_ms) * WATERMARK_LOWER_STEP_MS;
+  return (raised_ms > lowered_ms) ? raised_ms - lowered_ms : 0;
+}
+
+void I2SAudioSpeakerBase::record_underflow_() {
+  this->underflow_count_.fetch_add(1, std::memory_order_relaxed);
+  if (!this->adaptive_watermark_) {
+    return;
+  }
+
+  const uint32_t now = millis();
+  uint32_t offset_ms = this->watermark_offset_ms_(now);
+  if (this->underflow_seen_ &&
+      ((now - this->last_underflow_ms_.load(std::memory_order_relaxed)) < WATERMARK_UNDERFLOW_WINDOW_MS)) {
+    const uint32_t limit_ms = this->buffer_duration_ms_ * WATERMARK_LIMIT_PERCENT / 100;
+    const uint32_t highest_watermark_ms = std::max(this->start_watermark_ms_, this->resume_watermark_ms_);
+    const uint32_t offset_limit_ms = (limit_ms > highest_watermark_ms) ? limit_ms - highest_watermark_ms : 0;
+    offset_ms = std::min(offset_ms + WATERMARK_RAISE_STEP_MS, offset_limit_ms);
+  }
+  this->underflow_seen_ = true;
+  this->watermark_raised_ms_.store(offset_ms, std::memory_order_relaxed);
+  this->last_underflow_ms_.store(now, std::memory_order_relaxed);
+}
+
+void I2SAudioSpeakerBase::reset_schedule_() {
+  this->ring_bytes_written_.store(0, std::memory_order_relaxed);
+  this->scheduled_start_us_.store(0, std::memory_order_relaxed);
+  this->finish_byte_.store(0, std::memory_order_relaxed);
+  this->stream_bytes_consumed_ = 0;
+  this->schedule_pending_ = false;
+  this->stream_end_pending_ = false;
+}
+
+bool I2SAudioSpeakerBase::take_stream_end_() {
+  if (this->stream_end_pending_) {
+    return false;
+  }
+  xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::COMMAND_STOP_GRACEFULLY);
+  this->stream_end_byte_ = this->finish_byte_.load(std::memory_order_relaxed);
+  this->stream_end_pending_ = true;
+  return true;
+}
+
+void I2SAudioSpeakerBase::track_stream_boundary_(int64_t next_frame_us, size_t &stream_bytes) {
+  if (!this->stream_end_pending_) {
+    return;
+  }
+  if (this->stream_bytes_consumed_ < this->stream_end_byte_) {
+    stream_bytes = std::min<uint64_t>(stream_bytes, this->stream_end_byte_ - this->stream_bytes_consumed_);
+    return;
+  }
+  if (!this->stream_chained_()) {
+    stream_bytes = 0;
+    return;
+  }
+
+  const uint32_t head = this->stream_boundary_head_.load(std::memory_order_relaxed);
+  StreamBoundary &boundary = this->stream_boundaries_[head % STREAM_BOUNDARY_SLOTS];
+  boundary.frame = this->stream_end_byte_ / this->current_stream_info_.frames_to_bytes(1);
+  boundary.presentation_us = next_frame_us;
+  this->stream_boundary_head_.store(head + 1, std::memory_order_release);
+  this->stream_end_pending_ = false;
+}
+
+int32_t I2SAudioSpeakerBase::schedule_offset_frames_(int64_t next_frame_us, size_t &stream_bytes) {
+  if (!this->schedule_pending_) {
+    const int64_t presentation_time_us = this->scheduled_start_us_.exchange(0, std::memory_order_acquire);
+    if (presentation_time_us == 0) {
+      return 0;
+    }
+    this->schedule_start_byte_ = this->scheduled_start_byte_.load(std::memory_order_relaxed);
+    this->schedule_time_us_ = presentation_time_us;
+    this->schedule_pending_ = true;
+  }
+
+  if (this->stream_bytes_consumed_ < this->schedule_start_byte_) {
+    // Audio queued before the clip plays as usual, up to the clip's first frame
+    stream_bytes = std::min<uint64_t>(stream_bytes, this->schedule_start_byte_ - this->stream_bytes_consumed_);
+    return 0;
+  }
+
+  // The DSP chain's look-ahead delays every frame after it is converted
+  next_frame_us += this->current_stream_info_.frames_to_microseconds(this->dsp_.get_latency_frames());
+
+  // Whole sample pairs keep the ESP32 mono swap aligned
+  const int64_t granularity = (this->current_stream_info_.get_channels() == 1) ? 2 : 1;
+  int64_t offset_frames =
+      (this->schedule_time_us_ - next_frame_us) * this->current_stream_info_.get_sample_rate() / 1000000;
+  offset_frames -= offset_frames % granularity;
+  if (offset_frames == 0) {
+    this->schedule_pending_ = false;
+    return 0;
+  }
+
+  stream_bytes = 0;
+  return static_cast<int32_t>(std::max<int64_t>(std::min<int64_t>(offset_frames, INT32_MAX), -INT32_MAX));
+}
+
+void I2SAudioSpeakerBase::schedule_skip_(uint32_t frames) {
+  const size_t bytes = this->current_stream_info_.frames_to_bytes(frames);
+  this->stream_bytes_consumed_ += bytes;
+  this->schedule_start_byte_ += bytes;
+  this->schedule_time_us_ += this->current_stream_info_.frames_to_microseconds(frames);
+}
+
+void I2SAudioSpeakerBase::sync_reset_() {
+  this->sync_tracker_.start(this->current_stream_info_.get_sample_rate(), this->current_stream_info_.get_channels());
+}
+
+void I2SAudioSpeakerBase::sync_update_(int64_t dma_timestamp_us, uint32_t frames_sent,
+                                       uint32_t frames_per_dma_buffer) {
+  if (!this->sync_mode_) {
+    return;
+  }
+
+  struct timeval now_tv;
+  gettimeofday(&now_tv, nullptr);
+  if (now_tv.tv_sec < SYNC_MIN_VALID_EPOCH) {
+    this->sync_tracker_.reset();
+    return;
   }
-  return false;
+  // Translate the local DMA timestamp onto the reference clock
+  const int64_t reference_now_us = static_cast<int64_t>(now_tv.tv_sec) * 1000000 + now_tv.tv_usec;
+  this->sync_tracker_.update(dma_timestamp_us + (reference_now_us - esp_timer_get_time()), frames_sent,
+                             frames_per_dma_buffer);
 }
 
 void I2SAudioSpeakerBase::speaker_task(void *params) {
@@ -190,12 +564,16 @@ void I2SAudioSpeakerBase::start() {
     return;
 
   this->state_ = speaker::STATE_STARTING;
+  this->start_requested_us_.store(esp_timer_get_time(), std::memory_order_relaxed);
   xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::COMMAND_START);
 }
 
 void I2SAudioSpeakerBase::stop() { this->stop_(false); }
 
-void I2SAudioSpeakerBase::finish() { this->stop_(true); }
+void I2SAudioSpeakerBase::finish() {
+  this->finish_byte_.store(this->ring_bytes_written_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  this->stop_(true);
+}
 
 void I2SAudioSpeakerBase::stop_(bool wait_on_empty) {
   if (this->is_failed())
@@ -211,54 +589,154 @@ void I2SAudioSpeakerBase::stop_(bool wait_on_empty) {
 }
 
 bool IRAM_ATTR I2SAudioSpeakerBase::i2s_on_sent_cb(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
-  int64_t now = esp_timer_get_time();
-
-  BaseType_t need_yield1 = pdFALSE;
-  BaseType_t need_yield2 = pdFALSE;
-  BaseType_t need_yield3 = pdFALSE;
-
   I2SAudioSpeakerBase *this_speaker = (I2SAudioSpeakerBase *) user_ctx;
+  this_speaker->dma_events_.push(esp_timer_get_time(), event->dma_buf);
 
-  if (xQueueIsQueueFullFromISR(this_speaker->i2s_event_queue_)) {
-    // Queue is full, so discard the oldest event. Once we drop a completion event, i2s_event_queue_
-    // and any per-buffer record queue maintained by the task are permanently desynced, so the task
-    // must restart to recover. Set both ERR_DROPPED_EVENT (so loop() can log it) and COMMAND_STOP
-    // (so the task bails immediately, closing the race where loop() could clear the error bit
-    // before the task observes it).
-    int64_t dummy;
-    xQueueReceiveFromISR(this_speaker->i2s_event_queue_, &dummy, &need_yield1);
-    xEventGroupSetBitsFromISR(this_speaker->event_group_,
-                              SpeakerEventGroupBits::ERR_DROPPED_EVENT | SpeakerEventGroupBits::COMMAND_STOP,
-                              &need_yield2);
+  BaseType_t need_yield = pdFALSE;
+  TaskHandle_t waiter = this_speaker->dma_event_waiter_.load(std::memory_order_relaxed);
+  if (waiter != nullptr) {
+    vTaskNotifyGiveFromISR(waiter, &need_yield);
   }
-  xQueueSendToBackFromISR(this_speaker->i2s_event_queue_, &now, &need_yield3);
+  return need_yield;
+}
 
-  return need_yield1 | need_yield2 | need_yield3;
+void IRAM_ATTR DmaEventRing::push(int64_t timestamp, void *dma_buf) {
+  const uint32_t head = this->head_.load(std::memory_order_relaxed);
+  // Order the previous head update before this slot is overwritten, so a reader that sees a torn slot also sees that
+  // the ring has lapped it
+  std::atomic_thread_fence(std::memory_order_release);
+  DmaEvent &slot = this->events_[head & (CAPACITY - 1)];
+  slot.timestamp = timestamp;
+  slot.dma_buf = dma_buf;
+  slot.sequence = head;
+  this->head_.store(head + 1, std::memory_order_release);
 }
 
-void I2SAudioSpeakerBase::apply_software_volume_(uint8_t *data, size_t bytes_read) {
-  if (this->q31_volume_factor_ == INT32_MAX) {
-    return;  // Max volume, no processing needed
+bool DmaEventRing::pop(DmaEvent &event, uint32_t &missed) {
+  missed = 0;
+  while (true) {
+    const uint32_t head = this->head_.load(std::memory_order_acquire);
+    if (head == this->tail_) {
+      return false;
+    }
+    if (head - this->tail_ >= CAPACITY) {
+      // The ISR lapped the task; skip to the oldest slot it cannot be writing
+      const uint32_t oldest = head - CAPACITY + 1;
+      missed += oldest - this->tail_;
+      this->tail_ = oldest;
+    }
+
+    event = this->events_[this->tail_ & (CAPACITY - 1)];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->head_.load(std::memory_order_relaxed) - this->tail_ < CAPACITY) {
+      ++this->tail_;
+      return true;
+    }
+    // Overwritten while it was copied; try again from the new oldest slot
+  }
+}
+
+bool I2SAudioSpeakerBase::configure_output_kernel_() {
+  this->input_bytes_per_sample_ = this->current_stream_info_.samples_to_bytes(1);
+  this->output_bytes_per_sample_ = this->input_bytes_per_sample_;
+  if (this->slot_bit_width_ != I2S_SLOT_BIT_WIDTH_AUTO) {
+    this->output_bytes_per_sample_ = this->i2s_data_bits_per_sample() / 8;
+  }
+  if (this->dsp_.is_enabled()) {
+    const uint32_t sample_rate = this->current_stream_info_.get_sample_rate();
+    if (!this->dsp_.configure(sample_rate, this->current_stream_info_.get_channels())) {
+      ESP_LOGE(TAG, "DSP chain cannot run on this stream");
+      return false;
+    }
+    this->output_kernel_ =
+        kernels::select_dsp_output_kernel(this->input_bytes_per_sample_, this->output_bytes_per_sample_);
+    this->ramp_kernel_ = this->output_kernel_;
+  } else {
+    this->output_kernel_ =
+        kernels::select_output_kernel(this->input_bytes_per_sample_, this->output_bytes_per_sample_);
+    this->ramp_kernel_ =
+        kernels::select_ramp_output_kernel(this->input_bytes_per_sample_, this->output_bytes_per_sample_);
   }
+  return (this->output_kernel_ != nullptr) && (this->ramp_kernel_ != nullptr);
+}
 
-  const size_t bytes_per_sample = this->current_stream_info_.samples_to_bytes(1);
-  const uint32_t len = bytes_read / bytes_per_sample;
+uint32_t I2SAudioSpeakerBase::dsp_tail_frames_() const {
+  const uint32_t frames = this->dsp_.get_latency_frames();
+  return (this->current_stream_info_.get_channels() == 1) ? (frames + 1) & ~1u : frames;
+}
 
-  esp_audio_libs::gain::apply(data, data, this->q31_volume_factor_, len, bytes_per_sample);
+size_t I2SAudioSpeakerBase::flush_dsp_(uint8_t *out, uint32_t frames) {
+  static const uint8_t SILENCE[kernels::DSP_BLOCK_SAMPLES * sizeof(int32_t)] = {};
+  // Whole blocks of the DSP kernel are whole frames for every supported channel count
+  size_t samples = static_cast<size_t>(frames) * this->current_stream_info_.get_channels();
+  size_t bytes_written = 0;
+  while (samples > 0) {
+    const size_t block_samples = std::min(samples, kernels::DSP_BLOCK_SAMPLES);
+    bytes_written += this->process_output_(SILENCE, out + bytes_written, block_samples * this->input_bytes_per_sample_);
+    samples -= block_samples;
+  }
+  return bytes_written;
 }
 
-void I2SAudioSpeakerBase::swap_esp32_mono_samples_(uint8_t *data, size_t bytes_read) {
-#ifdef USE_ESP32_VARIANT_ESP32
-  if (this->current_stream_info_.get_channels() == 1 && this->current_stream_info_.get_bits_per_sample() == 16) {
-    int16_t *samples = reinterpret_cast<int16_t *>(data);
-    size_t sample_count = bytes_read / sizeof(int16_t);
-    for (size_t i = 0; i + 1 < sample_count; i += 2) {
-      int16_t tmp = samples[i];
-      samples[i] = samples[i + 1];
-      samples[i + 1] = tmp;
+// Multiplies two Q31 gains, keeping unity exact so the fast paths stay selectable
+static int32_t combine_gains(int32_t a, int32_t b) {
+  if (a == INT32_MAX) {
+    return b;
+  }
+  if (b == INT32_MAX) {
+    return a;
+  }
+  return static_cast<int32_t>((static_cast<int64_t>(a) * b) >> 31);
+}
+
+size_t I2SAudioSpeakerBase::process_output_(const uint8_t *in, uint8_t *out, size_t in_bytes) {
+  const uint32_t duck_requests = this->duck_requests_.load(std::memory_order_acquire);
+  if (duck_requests != this->duck_requests_seen_) {
+    this->duck_requests_seen_ = duck_requests;
+    this->duck_target_ = this->duck_request_gain_.load(std::memory_order_relaxed);
+    const uint32_t ramp_ms = this->duck_request_ramp_ms_.load(std::memory_order_relaxed);
+    const uint32_t ramp_pairs = std::max<uint32_t>(
+        1, this->current_stream_info_.ms_to_frames(ramp_ms) * this->current_stream_info_.get_channels() / 2);
+    this->duck_step_ =
+        static_cast<int32_t>((static_cast<int64_t>(this->duck_target_) - this->duck_gain_) / ramp_pairs);
+    this->duck_pairs_left_ = ramp_pairs;
+    if (this->duck_step_ == 0) {
+      // Too small a change to ramp; apply it outright
+      this->duck_gain_ = this->duck_target_;
+      this->duck_pairs_left_ = 0;
     }
   }
+
+  OutputKernelParams params;
+  params.q31_gain = combine_gains(this->q31_volume_factor_, this->duck_gain_);
+  params.dsp = &this->dsp_;
+#ifdef USE_ESP32_VARIANT_ESP32
+  params.swap_pairs =
+      (this->current_stream_info_.get_channels() == 1 && this->current_stream_info_.get_bits_per_sample() == 16);
 #endif  // USE_ESP32_VARIANT_ESP32
+
+  const size_t samples = in_bytes / this->input_bytes_per_sample_;
+  if (this->duck_pairs_left_ == 0) {
+    this->output_kernel_(in, out, samples, params);
+    return samples * this->output_bytes_per_sample_;
+  }
+
+  // Spread the change in the combined gain over the pairs left in the ramp. Truncating toward zero keeps the kernel
+  // from overshooting, and the gain snaps to the exact target once the ramp completes.
+  const uint32_t ramped = std::min<uint32_t>(this->duck_pairs_left_, samples / 2);
+  const int32_t end_gain = combine_gains(this->q31_volume_factor_, this->duck_target_);
+  params.q31_gain_step =
+      static_cast<int32_t>((static_cast<int64_t>(end_gain) - params.q31_gain) / this->duck_pairs_left_);
+  params.ramp_pairs = ramped;
+  this->ramp_kernel_(in, out, samples, params);
+
+  this->duck_pairs_left_ -= ramped;
+  if (this->duck_pairs_left_ == 0) {
+    this->duck_gain_ = this->duck_target_;
+  } else {
+    this->duck_gain_ += this->duck_step_ * static_cast<int32_t>(ramped);
+  }
+  return samples * this->output_bytes_per_sample_;
 }
 
 }  // namespace esphome::i2s_audio
@@ -3,18 +3,29 @@
 #ifdef USE_ESP32
 
 #include "../i2s_audio.h"
+#include "band_energy.h"
+#include "echo_reference.h"
+#include "i2s_audio_speaker_dsp.h"
+#include "i2s_audio_speaker_kernels.h"
+#include "speaker_sync_tracker.h"
+#include "speaker_task_profiler.h"
 
 #include <freertos/event_groups.h>
-#include <freertos/queue.h>
 #include <freertos/FreeRTOS.h>
 
+#include <atomic>
+
 #include "esphome/components/audio/audio.h"
+#include "esphome/components/audio_ring/audio_ring.h"
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
 #include "esphome/components/speaker/speaker.h"
+#include "esphome/components/timed_speaker/timed_speaker.h"
 
 #include "esphome/core/component.h"
 #include "esphome/core/gpio.h"
 #include "esphome/core/helpers.h"
-#include "esphome/components/ring_buffer/ring_buffer.h"
 
 namespace esphome::i2s_audio {
 
@@ -32,23 +43,58 @@ enum SpeakerEventGroupBits : uint32_t {
   TASK_RUNNING = (1 << 11),
   TASK_STOPPING = (1 << 12),
   TASK_STOPPED = (1 << 13),
+  TASK_STANDBY = (1 << 14),  // task parked with its channel and buffers kept, waiting to be woken
 
   ERR_ESP_NO_MEM = (1 << 19),
 
-  ERR_DROPPED_EVENT = (1 << 20),    // ISR overflowed the event queue, dropping a completion event
-  ERR_PARTIAL_WRITE = (1 << 21),    // a DMA write returned fewer bytes than requested (or the encoder
-                                    // failed to commit a complete block), which breaks the lockstep
-                                    // invariant for every subsequent event
-  ERR_LOCKSTEP_DESYNC = (1 << 22),  // i2s_event_queue_ and write_records_queue_ fell out of sync
-
   ALL_BITS = 0x00FFFFFF,  // All valid FreeRTOS event group bits
 };
 
+/// @brief Completion record pushed by the on_sent ISR for every DMA descriptor the hardware finished sending.
+struct DmaEvent {
+  int64_t timestamp;  // esp_timer time at which the descriptor finished sending
+  void *dma_buf;      // the descriptor's buffer, already cleared by the driver and free to refill
+  uint32_t sequence;  // completions since the ring was created; consecutive descriptors differ by one
+};
+
+/// @brief Lock-free single-producer, single-consumer ring of DMA completions. The on_sent ISR is the producer and never
+/// blocks or fails: when the task falls behind, the oldest events are overwritten. Every event carries a sequence
+/// number, so the task learns exactly how many completions it missed and accounts for them instead of restarting.
+class DmaEventRing {
+ public:
+  static constexpr uint32_t CAPACITY = 8;  // power of two; one slot stays unreadable while the ISR may be writing it
+
+  /// @brief Records a completion. Only called from the on_sent ISR.
+  void push(int64_t timestamp, void *dma_buf);
+
+  /// @brief Takes the oldest unread completion. Only called from the speaker task.
+  /// @param missed Set to the number of completions overwritten before `event` since the previous pop
+  /// @return False if there is nothing to read
+  bool pop(DmaEvent &event, uint32_t &missed);
+
+  /// @brief Discards unread completions. Only called from the speaker task.
+  void reset() { this->tail_ = this->head_.load(std::memory_order_acquire); }
+
+ protected:
+  DmaEvent events_[CAPACITY];
+  std::atomic<uint32_t> head_{0};  // sequence number of the next completion the ISR writes
+  uint32_t tail_{0};               // sequence number of the next completion the task reads
+};
+
+/// @brief Point where one chained stream ended and the next began.
+struct StreamBoundary {
+  uint64_t frame;           // stream frames the task had consumed before the new stream's first frame
+  int64_t presentation_us;  // esp_timer time at which the new stream's first frame is heard
+};
+
 /// @brief Abstract base class for I2S audio speaker implementations.
 /// Provides shared infrastructure: event groups, ring buffer, software volume control,
-/// task lifecycle, and common setup()/loop()/start()/stop()/play() logic.
+/// task lifecycle, playback timing, and common setup()/loop()/start()/stop()/play() logic.
 /// Derived classes implement run_speaker_task() and start_i2s_driver().
-class I2SAudioSpeakerBase : public I2SAudioOut, public speaker::Speaker, public Component {
+class I2SAudioSpeakerBase : public I2SAudioOut,
+                            public speaker::Speaker,
+                            public timed_speaker::TimedSpeaker,
+                            public Component {
  public:
   float get_setup_priority() const override { return esphome::setup_priority::PROCESSOR; }
 
@@ -59,10 +105,80 @@ class I2SAudioSpeakerBase : public I2SAudioOut, public speaker::Speaker, public
   void set_buffer_duration(uint32_t buffer_duration_ms) { this->buffer_duration_ms_ = buffer_duration_ms; }
   void set_timeout(uint32_t ms) { this->timeout_ = ms; }
 
+  /// @brief When enabled, the speaker task converts audio straight into DMA descriptors as the ISR reports them free,
+  /// instead of staging it in an output buffer and copying it with i2s_channel_write().
+  void set_direct_dma_write(bool direct_dma_write) { this->direct_dma_write_ = direct_dma_write; }
+
+  /// @brief When enabled, an underflow leaves the TX channel running on driver-cleared silence instead of disabling it
+  /// and preloading again. Audio resumes at the next descriptor boundary, and the silent descriptors are left out of
+  /// the timestamp accounting.
+  void set_seamless_underflow(bool seamless_underflow) { this->seamless_underflow_ = seamless_underflow; }
+
+  /// @brief When enabled, playback is disciplined to the system wall clock (set by SNTP or any other time source)
+  /// instead of free-running on the local I2S clock. Speakers syncing to the same clock stay aligned by inserting or
+  /// dropping single frames as their crystals drift.
+  void set_sync_mode(bool sync_mode) { this->sync_mode_ = sync_mode; }
+
+  /// @brief Audio that must be buffered before a stream starts playing. Absorbs the source's jitter at the cost of
+  /// start latency; 0 starts as soon as any audio arrives.
+  void set_start_watermark(uint32_t start_watermark_ms) { this->start_watermark_ms_ = start_watermark_ms; }
+  /// @brief Audio that must be buffered before playback resumes after an underflow.
+  void set_resume_watermark(uint32_t resume_watermark_ms) { this->resume_watermark_ms_ = resume_watermark_ms; }
+  /// @brief When enabled, both watermarks are raised after repeated underflows and lowered back toward their
+  /// configured values while the source stays steady.
+  void set_adaptive_watermark(bool adaptive_watermark) { this->adaptive_watermark_ = adaptive_watermark; }
+
+  /// @brief When enabled, the speaker task does not exit when playback stops. It keeps its buffers and the disabled TX
+  /// channel, and sleeps until the next start(), so a chime only waits for the channel to be re-enabled.
+  /// Unavailable on a port shared with a microphone, which must be able to recreate the channel pair.
+  void set_warm_standby(bool warm_standby) { this->warm_standby_ = warm_standby; }
+
+  /// @brief When enabled, streams of 16 bits or fewer are carried as 16-bit data words in the configured wider slots.
+  /// The words are sent MSB first and zero padded, so the DAC sees the same bus format, while the output buffers, DMA
+  /// descriptors and DMA traffic shrink to half.
+  void set_narrow_dma_data(bool narrow_dma_data) { this->narrow_dma_data_ = narrow_dma_data; }
+
+  /// @brief Appends a biquad to this output's EQ. Filters run in the order they are added.
+  void add_biquad(BiquadType type, float frequency, float gain_db, float q) {
+    this->dsp_.add_biquad(type, frequency, gain_db, q);
+  }
+  /// @brief Enables the look-ahead peak limiter after the EQ. The look-ahead adds to the output latency.
+  void set_limiter(float threshold_db, uint32_t look_ahead_ms, uint32_t release_ms) {
+    this->dsp_.set_limiter(threshold_db, look_ahead_ms, release_ms);
+  }
+
+#ifdef USE_SENSOR
+  SUB_SENSOR(watermark)
+  SUB_SENSOR(underflow_rate)
+  SUB_SENSOR(time_to_first_sample)
+  SUB_SENSOR(dma_margin)
+  SUB_SENSOR(task_load)
+#endif
+
   void start() override;
   void stop() override;
+  /// @brief Ends the stream once everything written so far has played. Audio in the same format written before the
+  /// speaker has drained chains onto the same DMA timeline instead, and the boundary is reported through the stream
+  /// boundary callbacks.
   void finish() override;
 
+  /// @brief Subscribes to the audio exactly as it is handed to the DMA, with the time each block is heard, for echo
+  /// cancellation. Call during setup; the returned ring stays owned by the speaker and starts out inactive.
+  /// @param capacity_bytes Size of the subscriber's ring; blocks are dropped whole when it is full
+  /// @return nullptr if the ring could not be allocated or too many subscribers exist
+  EchoReferenceRing *add_echo_reference_subscriber(size_t capacity_bytes);
+
+  /// @brief Band energies of the audio handed to the DMA, for audio-reactive visualizations. The analyzer is created on
+  /// the first call, which must happen during setup, and stays owned by the speaker. It only runs while acquired.
+  /// @return nullptr if the analyzer could not be allocated
+  BandEnergyAnalyzer *get_band_energy_analyzer();
+
+  /// @brief Registers a callback for gapless stream boundaries. Called from loop() with the stream frame position and
+  /// presentation time of each chained stream's first frame.
+  void add_on_stream_boundary_callback(std::function<void(uint64_t, int64_t)> &&callback) {
+    this->stream_boundary_callback_.add(std::move(callback));
+  }
+
   void set_pause_state(bool pause_state) override { this->pause_state_ = pause_state; }
   bool get_pause_state() const override { return this->pause_state_; }
 
@@ -71,9 +187,22 @@ class I2SAudioSpeakerBase : public I2SAudioOut, public speaker::Speaker, public
 
   bool has_buffered_data() const override;
 
+  /// @brief Ring buffer + task staging buffers + audio queued in DMA descriptors, measured from now.
+  uint32_t get_output_latency_us() const override;
+  int64_t get_next_presentation_time_us() const override;
+
+  /// @brief Writes audio to the ring buffer and schedules its first frame. The speaker task pads or trims when it
+  /// reaches that frame, so the first frame is heard within one frame of the requested time.
+  size_t play_at(const uint8_t *data, size_t length, int64_t presentation_time_us) override;
+
   void set_volume(float volume) override;
   void set_mute_state(bool mute_state) override;
 
+  /// @brief Ramps a ducking gain, applied on top of the volume, to `gain` (0.0 to 1.0) over `ramp_ms`. Bypasses the
+  /// ring buffer and takes effect on the next block the task converts, so only audio already queued in the DMA plays
+  /// at the old gain. Safe to call from any task, e.g. a wake word callback; a new call retargets a ramp in progress.
+  void duck(float gain, uint32_t ramp_ms);
+
  protected:
   /// @brief FreeRTOS task entry point. Casts params and calls run_speaker_task().
   static void speaker_task(void *params);
@@ -92,25 +221,278 @@ class I2SAudioSpeakerBase : public I2SAudioOut, public speaker::Speaker, public
 
   static bool IRAM_ATTR i2s_on_sent_cb(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
 
-  void apply_software_volume_(uint8_t *data, size_t bytes_read);
-  void swap_esp32_mono_samples_(uint8_t *data, size_t bytes_read);
+  /// @brief Selects the output kernel converting ``current_stream_info_`` samples into the I2S slot width, and prepares
+  /// the DSP chain for the stream if one is configured.
+  /// @return True if the combination of stream and slot widths is supported and the DSP chain is ready
+  bool configure_output_kernel_();
+
+  /// @brief Converts stream audio into DMA-format samples in a single fused pass: software volume, the DSP chain, the
+  /// ESP32 mono sample swap, and widening or narrowing to the I2S slot width.
+  /// @param in Stream-format audio from the ring buffer
+  /// @param out Destination for DMA-format audio; must hold ``output_bytes_(in_bytes)`` bytes
+  /// @param in_bytes Number of stream bytes to convert; should be a whole number of sample pairs
+  /// @return Number of bytes written to `out`
+  size_t process_output_(const uint8_t *in, uint8_t *out, size_t in_bytes);
+
+  /// @brief Frames of DMA-format audio the DSP chain still holds once a stream's last frame has gone in, rounded up to
+  /// whole sample pairs. 0 without a limiter.
+  uint32_t dsp_tail_frames_() const;
+
+  /// @brief Converts `frames` frames of silence through the output path, so the audio still in the DSP chain's delay
+  /// line comes out behind the stream's last frames.
+  /// @param out Destination for DMA-format audio; must hold ``output_bytes_`` of `frames` stream frames
+  /// @return Number of bytes written to `out`
+  size_t flush_dsp_(uint8_t *out, uint32_t frames);
+
+  /// @brief Data word width to carry `stream_info` in, or 0 to fill the whole slot. Never narrowed on a port shared
+  /// with a microphone, whose RX channel is configured together with the TX channel.
+  uint8_t negotiate_data_bits_(const audio::AudioStreamInfo &stream_info) const {
+    if (this->narrow_dma_data_ && !this->parent_->has_audio_in() && (this->i2s_bits_per_sample() > 16) &&
+        (stream_info.get_bits_per_sample() <= 16)) {
+      return 16;
+    }
+    return 0;
+  }
+
+  /// @brief Number of DMA-format bytes produced from `stream_bytes` of stream audio.
+  size_t output_bytes_(size_t stream_bytes) const {
+    return stream_bytes / this->input_bytes_per_sample_ * this->output_bytes_per_sample_;
+  }
+
+  /// @brief Starts a section timed by the task profiler. Free when USE_I2S_AUDIO_SPEAKER_PROFILING is not defined, as
+  /// are the other profile_*_() hooks.
+  ProfileMark profile_mark_() const {
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+    return this->profiler_.mark();
+#else
+    return {};
+#endif
+  }
+
+  /// @brief Ends a section started with profile_mark_() and adds its duration to the phase's histogram.
+  void profile_record_(SpeakerTaskPhase phase, const ProfileMark &start) {
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+    this->profiler_.record(phase, start);
+#endif
+  }
+
+  /// @brief Records the margin to the DMA deadline for audio just handed over.
+  /// @param deadline_us esp_timer time at which that audio starts playing
+  void profile_margin_(int64_t deadline_us) {
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+    this->profiler_.record_margin(deadline_us - esp_timer_get_time());
+#endif
+  }
+
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+  /// @brief Logs the task timing histograms, publishes the profiling sensors, and starts a new window.
+  void report_profile_(uint32_t elapsed_ms);
+#endif
+
+  /// @brief Restarts drift tracking; the next full DMA buffer becomes the new reference point. Called by the task
+  /// whenever playback is (re)started or the stream was interrupted.
+  void sync_reset_();
+
+  /// @brief Feeds one DMA completion into the drift tracker. Only called from the speaker task.
+  /// @param dma_timestamp_us esp_timer time at which the descriptor finished sending
+  /// @param frames_sent Stream frames the descriptor carried; fewer than `frames_per_dma_buffer` means an underflow
+  /// @param frames_per_dma_buffer Frames in a full descriptor
+  void sync_update_(int64_t dma_timestamp_us, uint32_t frames_sent, uint32_t frames_per_dma_buffer);
+
+  /// @brief Correction the tracker wants applied to the stream: positive to repeat that many frames, negative to skip
+  /// them, 0 when in sync. Always a whole number of sample pairs so the ESP32 mono swap stays aligned.
+  int32_t sync_pending_frames_() const { return this->sync_tracker_.pending_frames(); }
+
+  /// @brief Records that the task inserted or dropped the pending frames.
+  void sync_correction_applied_() { this->sync_tracker_.correction_applied(); }
+
+  /// @brief Audio the task waits for before it writes to an idle or underflowed DMA, in milliseconds.
+  /// @param resuming True after an underflow, false when the stream is starting
+  uint32_t watermark_ms_(bool resuming) const;
+
+  /// @brief Amount the adaptive mode has raised the watermarks by, decayed for the time since the last underflow.
+  uint32_t watermark_offset_ms_(uint32_t now) const;
+
+  /// @brief Records that a playing stream ran dry. In adaptive mode, raises the watermarks if underflows repeat.
+  /// Only called from the speaker task.
+  void record_underflow_();
+
+  /// @brief Records when the first frame after start() will be heard, completing the time-to-first-sample metric.
+  /// Only the first call after each start() counts. Only called from the speaker task.
+  void record_first_sample_(int64_t first_sample_us) {
+    if (this->start_requested_us_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    const int64_t start_requested_us = this->start_requested_us_.exchange(0, std::memory_order_relaxed);
+    if (start_requested_us != 0) {
+      const int64_t latency_us = std::max<int64_t>(1, first_sample_us - start_requested_us);
+      this->first_sample_latency_us_.store(static_cast<uint32_t>(std::min<int64_t>(latency_us, UINT32_MAX)),
+                                           std::memory_order_relaxed);
+    }
+  }
+
+  /// @brief Copies DMA-format audio to every active echo reference subscriber and feeds it to the band energy
+  /// analyzer while that is active. Only called from the speaker task.
+  /// @param presentation_us esp_timer time at which the first frame is heard
+  void tap_played_audio_(const uint8_t *data, size_t bytes, int64_t presentation_us) {
+    const audio::AudioStreamInfo played_info(this->output_bytes_per_sample_ * 8,
+                                             this->current_stream_info_.get_channels(),
+                                             this->current_stream_info_.get_sample_rate());
+    for (size_t i = 0; i < this->echo_reference_count_; ++i) {
+      EchoReferenceRing *ring = this->echo_references_[i].get();
+      if (ring->is_active()) {
+        ring->write(data, bytes, presentation_us, played_info);
+      }
+    }
+    if ((this->band_energy_ != nullptr) && this->band_energy_->is_active()) {
+      this->band_energy_->analyze(data, bytes, presentation_us, played_info);
+    }
+  }
+
+  /// @brief Takes a finish() request for the task, recording where the finished stream ends. A request made while an
+  /// earlier stream end is still ahead of the task is left pending until that boundary has been reached.
+  /// @return True if the task should now stop gracefully
+  bool take_stream_end_();
+
+  /// @brief True once audio written after the pending stream end shows that another stream is chained onto it.
+  bool stream_chained_() const {
+    return this->stream_end_pending_ &&
+           (this->ring_bytes_written_.load(std::memory_order_relaxed) > this->stream_end_byte_);
+  }
+
+  /// @brief Keeps the task from converting past the end of a finished stream, and reports the boundary once the next
+  /// stream's first frame is about to be converted.
+  /// @param next_frame_us esp_timer time at which the next converted frame will be heard
+  /// @param stream_bytes In: stream bytes the task could consume. Out: limited to the end of the finished stream
+  void track_stream_boundary_(int64_t next_frame_us, size_t &stream_bytes);
+
+  /// @brief Clears the stream position and any pending play_at() schedule. Called by the task before it publishes a
+  /// new ring buffer.
+  void reset_schedule_();
+
+  /// @brief Checks the pending play_at() schedule against the next stream frame the task is about to queue.
+  /// @param next_frame_us esp_timer time at which the next queued frame will be heard
+  /// @param stream_bytes In: stream bytes the task could consume. Out: limited so audio queued before the scheduled
+  /// clip plays normally, and 0 while the clip is being held back
+  /// @return Frames of silence to queue before the clip (positive), frames of the clip to discard (negative), or 0
+  int32_t schedule_offset_frames_(int64_t next_frame_us, size_t &stream_bytes);
+
+  /// @brief Records that the task discarded `frames` from the start of the scheduled clip.
+  void schedule_skip_(uint32_t frames);
 
   TaskHandle_t speaker_task_handle_{nullptr};
   EventGroupHandle_t event_group_{nullptr};
 
   // Weak pointer: task owns the shared_ptr; base holds a weak ref for play() / has_buffered_data()
-  std::weak_ptr<ring_buffer::RingBuffer> audio_ring_buffer_;
+  std::weak_ptr<audio_ring::AudioRing> audio_ring_buffer_;
+  // Held while the task replaces audio_ring_buffer_ or current_stream_info_, and while other tasks read them. The
+  // task reads its own copies without it.
+  mutable Mutex stream_lock_;
 
   uint32_t buffer_duration_ms_;
   optional<uint32_t> timeout_;
   bool pause_state_{false};
+  bool direct_dma_write_{false};
+  bool seamless_underflow_{false};
   int32_t q31_volume_factor_{INT32_MAX};
 
-  // Lockstepped DMA buffer queues: i2s_event is outgoing, write_records is incoming
-  QueueHandle_t i2s_event_queue_{nullptr};
-  QueueHandle_t write_records_queue_{nullptr};
-
-  audio::AudioStreamInfo current_stream_info_;
+  // Ducking. duck() posts a request from any task; the speaker task owns the ramp and runs it in process_output_().
+  std::atomic<int32_t> duck_request_gain_{INT32_MAX};
+  std::atomic<uint32_t> duck_request_ramp_ms_{0};
+  std::atomic<uint32_t> duck_requests_{0};  // bumped after the two fields above are written
+  uint32_t duck_requests_seen_{0};
+  int32_t duck_gain_{INT32_MAX};
+  int32_t duck_target_{INT32_MAX};
+  int32_t duck_step_{0};  // Q31 change per sample pair, truncated toward zero so the ramp never overshoots
+  uint32_t duck_pairs_left_{0};
+
+  // DMA completions from the on_sent ISR. A task that blocks waiting for them sets dma_event_waiter_ to be notified.
+  DmaEventRing dma_events_;
+  std::atomic<TaskHandle_t> dma_event_waiter_{nullptr};
+  std::atomic<uint32_t> missed_dma_events_{0};  // counted by the task, logged and cleared by loop()
+
+  audio::AudioStreamInfo current_stream_info_;  // format of the audio in the ring buffer; see stream_lock_
+
+  /// @brief Publishes the task's view of the DMA timeline for the latency API.
+  /// @param dma_queue_end_us Time at which every frame already handed to the DMA has played
+  /// @param next_dma_slot_us Earliest time a frame not yet handed to the DMA could start playing (0 if immediately)
+  /// @param staged_frames Frames held in the task's own staging buffers
+  void publish_playback_timing_(int64_t dma_queue_end_us, int64_t next_dma_slot_us, uint32_t staged_frames) {
+    this->dma_queue_end_us_.store(dma_queue_end_us, std::memory_order_relaxed);
+    this->next_dma_slot_us_.store(next_dma_slot_us, std::memory_order_relaxed);
+    this->staged_frames_.store(staged_frames, std::memory_order_relaxed);
+  }
+
+  // Playback timeline written by the speaker task and read from any task by the latency API
+  std::atomic<int64_t> dma_queue_end_us_{0};
+  std::atomic<int64_t> next_dma_slot_us_{0};
+  std::atomic<uint32_t> staged_frames_{0};
+
+  // play_at() schedule handed from the caller to the task; a start time of 0 means nothing is scheduled
+  std::atomic<int64_t> scheduled_start_us_{0};
+  std::atomic<uint64_t> scheduled_start_byte_{0};
+  std::atomic<uint64_t> ring_bytes_written_{0};
+
+  // Schedule state owned by the speaker task
+  uint64_t stream_bytes_consumed_{0};  // stream bytes the task has taken out of the ring buffer
+  uint64_t schedule_start_byte_{0};
+  int64_t schedule_time_us_{0};
+  bool schedule_pending_{false};
+
+  SyncTracker sync_tracker_;  // owned by the speaker task
+  bool sync_mode_{false};
+
+  // Jitter watermarks. The adaptive offset and underflow count are written by the speaker task and read by loop().
+  uint32_t start_watermark_ms_{0};
+  uint32_t resume_watermark_ms_{0};
+  bool adaptive_watermark_{false};
+  bool underflow_seen_{false};
+  std::atomic<uint32_t> watermark_raised_ms_{0};  // offset as of the last underflow, before any decay
+  std::atomic<uint32_t> last_underflow_ms_{0};
+  std::atomic<uint32_t> underflow_count_{0};  // cleared by loop() when it publishes the underflow rate
+#ifdef USE_SENSOR
+  uint32_t last_sensor_publish_ms_{0};
+#endif
+
+  // Stream chaining. finish() records the end position; the task owns the pending boundary and reports reached ones
+  // through a small ring drained by loop().
+  static constexpr uint32_t STREAM_BOUNDARY_SLOTS = 4;
+  std::atomic<uint64_t> finish_byte_{0};
+  uint64_t stream_end_byte_{0};
+  bool stream_end_pending_{false};
+  StreamBoundary stream_boundaries_[STREAM_BOUNDARY_SLOTS];
+  std::atomic<uint32_t> stream_boundary_head_{0};
+  uint32_t stream_boundary_tail_{0};
+  CallbackManager<void(uint64_t, int64_t)> stream_boundary_callback_;
+
+  // Echo reference subscribers, added during setup and never removed
+  static constexpr size_t MAX_ECHO_REFERENCE_SUBSCRIBERS = 2;
+  std::unique_ptr<EchoReferenceRing> echo_references_[MAX_ECHO_REFERENCE_SUBSCRIBERS];
+  size_t echo_reference_count_{0};
+
+  // Created during setup when an audio-reactive effect asks for it
+  std::unique_ptr<BandEnergyAnalyzer> band_energy_;
+
+  // Warm standby: loop() sets standby_wake_ and notifies the parked task
+  bool warm_standby_{false};
+  std::atomic<bool> standby_wake_{false};
+
+  // Time-to-first-sample: start() stamps the request, the task measures it, loop() reports it (0 means no new result)
+  std::atomic<int64_t> start_requested_us_{0};
+  std::atomic<uint32_t> first_sample_latency_us_{0};
+
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+  SpeakerTaskProfiler profiler_;
+  uint32_t last_profile_report_ms_{0};
+#endif
+
+  bool narrow_dma_data_{false};
+
+  OutputDsp dsp_;
+  OutputKernel output_kernel_{nullptr};
+  OutputKernel ramp_kernel_{nullptr};  // used instead of output_kernel_ while a duck ramp is in progress
+  uint8_t input_bytes_per_sample_{2};
+  uint8_t output_bytes_per_sample_{2};
 };
 
 }  // namespace esphome::i2s_audio
@@ -0,0 +1,188 @@
+#include "i2s_audio_speaker_dsp.h"
+
+#ifdef USE_ESP32
+
+#include <cmath>
+#include <new>
+
+namespace esphome::i2s_audio {
+
+static constexpr float PI_F = 3.14159265358979f;
+
+static int32_t to_fixed(float value, int shift) {
+  const float scaled = std::ldexp(value, shift);
+  return static_cast<int32_t>(std::lround(std::clamp(scaled, static_cast<float>(INT32_MIN), 2147483520.0f)));
+}
+
+bool Biquad::configure(uint32_t sample_rate) {
+  if ((sample_rate == 0) || (this->frequency <= 0.0f) || (this->frequency >= sample_rate / 2.0f)) {
+    return false;
+  }
+
+  // Audio EQ Cookbook (R. Bristow-Johnson) coefficients, normalized by a0
+  const float w0 = 2.0f * PI_F * this->frequency / static_cast<float>(sample_rate);
+  const float cos_w0 = std::cos(w0);
+  const float alpha = std::sin(w0) / (2.0f * this->q);
+  const float a = std::pow(10.0f, this->gain_db / 40.0f);
+  const float sqrt_a_alpha = 2.0f * std::sqrt(a) * alpha;
+
+  float b0, b1, b2, a0, a1, a2;
+  switch (this->type) {
+    case BiquadType::LOW_SHELF:
+      b0 = a * ((a + 1.0f) - (a - 1.0f) * cos_w0 + sqrt_a_alpha);
+      b1 = 2.0f * a * ((a - 1.0f) - (a + 1.0f) * cos_w0);
+      b2 = a * ((a + 1.0f) - (a - 1.0f) * cos_w0 - sqrt_a_alpha);
+      a0 = (a + 1.0f) + (a - 1.0f) * cos_w0 + sqrt_a_alpha;
+      a1 = -2.0f * ((a - 1.0f) + (a + 1.0f) * cos_w0);
+      a2 = (a + 1.0f) + (a - 1.0f) * cos_w0 - sqrt_a_alpha;
+      break;
+    case BiquadType::HIGH_SHELF:
+      b0 = a * ((a + 1.0f) + (a - 1.0f) * cos_w0 + sqrt_a_alpha);
+      b1 = -2.0f * a * ((a - 1.0f) + (a + 1.0f) * cos_w0);
+      b2 = a * ((a + 1.0f) + (a - 1.0f) * cos_w0 - sqrt_a_alpha);
+      a0 = (a + 1.0f) - (a - 1.0f) * cos_w0 + sqrt_a_alpha;
+      a1 = 2.0f * ((a - 1.0f) - (a + 1.0f) * cos_w0);
+      a2 = (a + 1.0f) - (a - 1.0f) * cos_w0 - sqrt_a_alpha;
+      break;
+    case BiquadType::LOW_PASS:
+      b0 = (1.0f - cos_w0) / 2.0f;
+      b1 = 1.0f - cos_w0;
+      b2 = b0;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha;
+      break;
+    case BiquadType::HIGH_PASS:
+      b0 = (1.0f + cos_w0) / 2.0f;
+      b1 = -(1.0f + cos_w0);
+      b2 = b0;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha;
+      break;
+    case BiquadType::BAND_PASS:
+      // Constant 0 dB peak gain at the centre frequency
+      b0 = alpha;
+      b1 = 0.0f;
+      b2 = -alpha;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha;
+      break;
+    case BiquadType::PEAKING:
+    default:
+      b0 = 1.0f + alpha * a;
+      b1 = -2.0f * cos_w0;
+      b2 = 1.0f - alpha * a;
+      a0 = 1.0f + alpha / a;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha / a;
+      break;
+  }
+
+  this->b0_ = to_fixed(b0 / a0, COEFFICIENT_SHIFT);
+  this->b1_ = to_fixed(b1 / a0, COEFFICIENT_SHIFT);
+  this->b2_ = to_fixed(b2 / a0, COEFFICIENT_SHIFT);
+  this->a1_ = to_fixed(a1 / a0, COEFFICIENT_SHIFT);
+  this->a2_ = to_fixed(a2 / a0, COEFFICIENT_SHIFT);
+  this->reset();
+  return true;
+}
+
+bool PeakLimiter::configure(uint32_t sample_rate, uint8_t channels) {
+  // Rounded up, so the look-ahead never comes out shorter than asked for at rates like 22050 or 44100 Hz
+  const uint32_t look_ahead_frames = std::max<uint32_t>(
+      1, static_cast<uint32_t>((static_cast<uint64_t>(sample_rate) * this->look_ahead_ms + 999) / 1000));
+  const size_t delay_length = static_cast<size_t>(look_ahead_frames) * channels;
+  if (delay_length != this->delay_length_) {
+    this->delay_line_.reset(new (std::nothrow) int32_t[delay_length]);
+    if (this->delay_line_ == nullptr) {
+      this->delay_length_ = 0;
+      return false;
+    }
+    this->delay_length_ = delay_length;
+  }
+  this->look_ahead_frames_ = look_ahead_frames;
+  this->channels_ = channels;
+
+  this->threshold_ = to_fixed(std::pow(10.0f, this->threshold_db / 20.0f), 31);
+  const uint32_t release_frames =
+      std::max<uint32_t>(1, static_cast<uint32_t>(static_cast<uint64_t>(sample_rate) * this->release_ms / 1000));
+  this->release_step_ = std::max<int32_t>(1, INT32_MAX / release_frames);
+  this->reset();
+  return true;
+}
+
+void PeakLimiter::reset() {
+  std::fill_n(this->delay_line_.get(), this->delay_length_, 0);
+  this->delay_position_ = 0;
+  this->gain_ = INT32_MAX;
+  this->target_ = INT32_MAX;
+  this->attack_step_ = 0;
+  this->hold_frames_ = 0;
+}
+
+void PeakLimiter::process(int32_t *samples, size_t count) {
+  const uint8_t channels = this->channels_;
+  int32_t *delay_line = this->delay_line_.get();
+
+  for (size_t i = 0; i < count; i += channels) {
+    int32_t peak = 0;
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+      const int32_t s = samples[i + ch];
+      peak = std::max(peak, (s == INT32_MIN) ? INT32_MAX : std::abs(s));
+    }
+
+    if (peak > this->threshold_) {
+      // Ramp down so the gain reaches the required level by the time this frame leaves the delay line. A steeper ramp
+      // still in progress for an earlier peak is kept, so that peak is never reached late.
+      const int32_t required = static_cast<int32_t>((static_cast<int64_t>(this->threshold_) << 31) / peak);
+      if (required < this->target_) {
+        this->target_ = required;
+        const int32_t step = (this->gain_ - required) / static_cast<int32_t>(this->look_ahead_frames_) + 1;
+        this->attack_step_ = std::max(this->attack_step_, step);
+      }
+      this->hold_frames_ = this->look_ahead_frames_;
+    }
+
+    if (this->gain_ > this->target_) {
+      this->gain_ = std::max(this->target_, this->gain_ - this->attack_step_);
+    } else if (this->hold_frames_ > 0) {
+      --this->hold_frames_;
+    } else if (this->gain_ < INT32_MAX) {
+      this->target_ = INT32_MAX;
+      this->attack_step_ = 0;
+      this->gain_ = static_cast<int32_t>(
+          std::min<int64_t>(INT32_MAX, static_cast<int64_t>(this->gain_) + this->release_step_));
+    }
+
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+      const int32_t delayed = delay_line[this->delay_position_ + ch];
+      delay_line[this->delay_position_ + ch] = samples[i + ch];
+      const int32_t limited = static_cast<int32_t>((static_cast<int64_t>(delayed) * this->gain_) >> 31);
+      // Rounding in the gain ramp can leave a peak a few LSBs over; clip those outright
+      samples[i + ch] = std::clamp(limited, -this->threshold_, this->threshold_);
+    }
+    this->delay_position_ += channels;
+    if (this->delay_position_ >= this->delay_length_) {
+      this->delay_position_ = 0;
+    }
+  }
+}
+
+bool OutputDsp::configure(uint32_t sample_rate, uint8_t channels) {
+  if ((channels == 0) || (channels > Biquad::MAX_CHANNELS)) {
+    return false;
+  }
+  this->channels_ = channels;
+  for (Biquad &biquad : this->biquads_) {
+    if (!biquad.configure(sample_rate)) {
+      return false;
+    }
+  }
+  return !this->limiter_enabled_ || this->limiter_.configure(sample_rate, channels);
+}
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
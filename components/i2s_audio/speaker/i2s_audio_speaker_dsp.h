@@ -0,0 +1,240 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "i2s_audio_speaker_kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace esphome::i2s_audio {
+
+enum class BiquadType : uint8_t {
+  PEAKING,
+  LOW_SHELF,
+  HIGH_SHELF,
+  LOW_PASS,
+  HIGH_PASS,
+  BAND_PASS,
+};
+
+/// @brief One second-order section, run in direct form I on Q31 samples with Q28 coefficients (range +/-8), so shelves
+/// and peaks of up to +/-12 dB stay representable.
+class Biquad {
+ public:
+  static constexpr uint8_t MAX_CHANNELS = 2;
+
+  BiquadType type{BiquadType::PEAKING};
+  float frequency{1000.0f};
+  float gain_db{0.0f};
+  float q{0.707f};
+
+  /// @brief Computes the coefficients for `sample_rate` and clears the filter history.
+  /// @return False if the corner frequency is not below the Nyquist frequency
+  bool configure(uint32_t sample_rate);
+
+  /// @brief Clears the filter history so the next stream does not start with the last one's ringing.
+  void reset() {
+    for (State &state : this->state_) {
+      state = State{};
+    }
+  }
+
+  /// @brief Filters interleaved samples in place. Each channel runs as its own loop so its history stays in registers.
+  void process(int32_t *samples, size_t count, uint8_t channels) {
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+      State state = this->state_[ch];
+      for (size_t i = ch; i < count; i += channels) {
+        const int32_t x = samples[i];
+        const int64_t acc = static_cast<int64_t>(this->b0_) * x + static_cast<int64_t>(this->b1_) * state.x1 +
+                            static_cast<int64_t>(this->b2_) * state.x2 - static_cast<int64_t>(this->a1_) * state.y1 -
+                            static_cast<int64_t>(this->a2_) * state.y2;
+        const int32_t y = static_cast<int32_t>(std::clamp<int64_t>(acc >> COEFFICIENT_SHIFT, INT32_MIN, INT32_MAX));
+        state.x2 = state.x1;
+        state.x1 = x;
+        state.y2 = state.y1;
+        state.y1 = y;
+        samples[i] = y;
+      }
+      this->state_[ch] = state;
+    }
+  }
+
+ protected:
+  static constexpr int COEFFICIENT_SHIFT = 28;
+
+  struct State {
+    int32_t x1{0};
+    int32_t x2{0};
+    int32_t y1{0};
+    int32_t y2{0};
+  };
+
+  int32_t b0_{1 << COEFFICIENT_SHIFT};
+  int32_t b1_{0};
+  int32_t b2_{0};
+  int32_t a1_{0};
+  int32_t a2_{0};
+  State state_[MAX_CHANNELS];
+};
+
+/// @brief Look-ahead peak limiter. Samples are delayed by the look-ahead while the gain ramps down ahead of any peak
+/// above the threshold, holds until the peak has passed, then recovers linearly over the release time.
+class PeakLimiter {
+ public:
+  float threshold_db{-1.0f};
+  uint32_t look_ahead_ms{1};
+  uint32_t release_ms{100};
+
+  /// @brief Allocates the look-ahead delay line for the stream and clears it. Not real-time safe.
+  /// @return False if the delay line could not be allocated
+  bool configure(uint32_t sample_rate, uint8_t channels);
+
+  /// @brief Empties the delay line and returns to unity gain, so audio held back from one stream never plays at the
+  /// start of the next. Real-time safe.
+  void reset();
+
+  /// @brief Limits interleaved samples in place. `count` must be a whole number of frames.
+  void process(int32_t *samples, size_t count);
+
+  /// @brief Frames the limiter delays the audio by.
+  uint32_t get_latency_frames() const { return this->look_ahead_frames_; }
+
+ protected:
+  std::unique_ptr<int32_t[]> delay_line_;
+  size_t delay_length_{0};    // samples in the delay line; look_ahead_frames_ * channels_
+  size_t delay_position_{0};  // next sample to leave the delay line
+  uint32_t look_ahead_frames_{0};
+  uint8_t channels_{1};
+
+  int32_t threshold_{INT32_MAX};
+  int32_t gain_{INT32_MAX};    // Q31 gain applied to the delayed samples
+  int32_t target_{INT32_MAX};  // gain the ramp is heading for
+  int32_t attack_step_{0};
+  int32_t release_step_{0};
+  uint32_t hold_frames_{0};
+};
+
+/// @brief Per-output insert chain: cascaded biquads followed by an optional limiter, run on Q31 samples inside the
+/// fused output pass. Configured for a stream by the speaker before its task starts converting audio.
+class OutputDsp {
+ public:
+  void add_biquad(BiquadType type, float frequency, float gain_db, float q) {
+    Biquad biquad;
+    biquad.type = type;
+    biquad.frequency = frequency;
+    biquad.gain_db = gain_db;
+    biquad.q = q;
+    this->biquads_.push_back(biquad);
+  }
+
+  void set_limiter(float threshold_db, uint32_t look_ahead_ms, uint32_t release_ms) {
+    this->limiter_.threshold_db = threshold_db;
+    this->limiter_.look_ahead_ms = look_ahead_ms;
+    this->limiter_.release_ms = release_ms;
+    this->limiter_enabled_ = true;
+  }
+
+  bool is_enabled() const { return !this->biquads_.empty() || this->limiter_enabled_; }
+  size_t get_biquad_count() const { return this->biquads_.size(); }
+  bool is_limiter_enabled() const { return this->limiter_enabled_; }
+  const PeakLimiter &get_limiter() const { return this->limiter_; }
+
+  /// @brief Prepares the chain for a stream and clears all filter and delay state. Not real-time safe.
+  /// @return False if a filter is invalid at this sample rate or the limiter's delay line could not be allocated
+  bool configure(uint32_t sample_rate, uint8_t channels);
+
+  /// @brief Clears all filter and delay state for a new stream, keeping the configuration. Real-time safe.
+  void reset() {
+    for (Biquad &biquad : this->biquads_) {
+      biquad.reset();
+    }
+    if (this->limiter_enabled_) {
+      this->limiter_.reset();
+    }
+  }
+
+  /// @brief Runs the chain over interleaved Q31 samples in place. `count` must be a whole number of frames.
+  void process(int32_t *samples, size_t count) {
+    for (Biquad &biquad : this->biquads_) {
+      biquad.process(samples, count, this->channels_);
+    }
+    if (this->limiter_enabled_) {
+      this->limiter_.process(samples, count);
+    }
+  }
+
+  /// @brief Frames the chain delays the audio by.
+  uint32_t get_latency_frames() const { return this->limiter_enabled_ ? this->limiter_.get_latency_frames() : 0; }
+
+ protected:
+  std::vector<Biquad> biquads_;
+  PeakLimiter limiter_;
+  bool limiter_enabled_{false};
+  uint8_t channels_{1};
+};
+
+namespace kernels {
+
+// Samples lifted to Q31 per DSP block; a multiple of every channel count so blocks always hold whole frames
+static constexpr size_t DSP_BLOCK_SAMPLES = 64;
+
+/// @brief Fused converter with the DSP chain inserted: lifts a block of samples to Q31 and applies volume, runs the
+/// chain over it while it is still in a small stack block, then pair-swaps and stores it at the output width. Blocks
+/// are read in full before they are written, so the aliasing rules match convert_output(). Also serves as the ramp
+/// kernel when the chain is enabled, so the gain ramp is applied ahead of the limiter.
+template<size_t InBytes, size_t OutBytes>
+inline void dsp_output(const uint8_t *in, uint8_t *out, size_t samples, const OutputKernelParams &params) {
+  int32_t block[DSP_BLOCK_SAMPLES];
+  int32_t gain = params.q31_gain;
+  size_t ramp_pairs = params.ramp_pairs;
+  const size_t first = params.swap_pairs ? 1 : 0;
+
+  for (size_t start = 0; start < samples; start += DSP_BLOCK_SAMPLES) {
+    const size_t count = std::min(samples - start, DSP_BLOCK_SAMPLES);
+    for (size_t i = 0; i < count; ++i) {
+      const int32_t s = load_q31<InBytes>(in + (start + i) * InBytes);
+      block[i] = (gain == INT32_MAX) ? s : scale<0>(s, gain);
+      if ((i & 1) && (ramp_pairs > 0)) {
+        gain += params.q31_gain_step;
+        --ramp_pairs;
+      }
+    }
+
+    params.dsp->process(block, count);
+
+    const size_t pairs = count / 2;
+    uint8_t *block_out = out + start * OutBytes;
+    for (size_t i = 0; i < pairs; ++i) {
+      store_q31<OutBytes>(block[2 * i], block_out + (2 * i + first) * OutBytes);
+      store_q31<OutBytes>(block[2 * i + 1], block_out + (2 * i + 1 - first) * OutBytes);
+    }
+    if (count & 1) {
+      store_q31<OutBytes>(block[count - 1], block_out + (count - 1) * OutBytes);
+    }
+  }
+}
+
+/// @brief Returns the DSP kernel converting `in_bytes` wide stream samples into `out_bytes` wide DMA samples, or
+/// nullptr if either width is unsupported.
+inline OutputKernel select_dsp_output_kernel(size_t in_bytes, size_t out_bytes) {
+  if (in_bytes < 1 || in_bytes > 4 || out_bytes < 1 || out_bytes > 4) {
+    return nullptr;
+  }
+
+  static constexpr OutputKernel DSP_KERNELS[4][4] = {
+      {&dsp_output<1, 1>, &dsp_output<1, 2>, &dsp_output<1, 3>, &dsp_output<1, 4>},
+      {&dsp_output<2, 1>, &dsp_output<2, 2>, &dsp_output<2, 3>, &dsp_output<2, 4>},
+      {&dsp_output<3, 1>, &dsp_output<3, 2>, &dsp_output<3, 3>, &dsp_output<3, 4>},
+      {&dsp_output<4, 1>, &dsp_output<4, 2>, &dsp_output<4, 3>, &dsp_output<4, 4>},
+  };
+  return DSP_KERNELS[in_bytes - 1][out_bytes - 1];
+}
+
+}  // namespace kernels
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
@@ -0,0 +1,217 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome::i2s_audio {
+
+class OutputDsp;
+
+/// @brief Per-block parameters for the fused output kernels. The speaker task builds this once per block so the inner
+/// loops carry no per-sample branches.
+struct OutputKernelParams {
+  int32_t q31_gain{INT32_MAX};  // software volume; INT32_MAX is unity and skips the multiply
+  bool swap_pairs{false};       // swap every adjacent pair of samples (ESP32 16-bit mono quirk, or L/R swap)
+  OutputDsp *dsp{nullptr};      // insert chain run by the DSP kernels; unused by the others
+  int32_t q31_gain_step{0};     // ramp kernels only: added to the gain after each sample pair...
+  uint32_t ramp_pairs{0};       // ...for this many pairs, after which the gain holds
+};
+
+/// @brief Signature shared by every output kernel instantiation. Chosen once per stream by select_output_kernel() so
+/// the per-block call is a single indirect jump into a fully specialized loop.
+using OutputKernel = void (*)(const uint8_t *in, uint8_t *out, size_t samples, const OutputKernelParams &params);
+
+namespace kernels {
+
+/// @brief Scales a Q(n) sample by a Q31 gain and shifts the result into a Q(n + shift) container.
+template<int Shift> inline int32_t scale(int32_t sample, int32_t q31_gain) {
+  return static_cast<int32_t>((static_cast<int64_t>(sample) * q31_gain) >> (31 - Shift));
+}
+
+/// @brief Reads `samples` from `in`, applies gain, optional pair swap, and widening by `Shift` bits, then writes the
+/// final DMA-format samples to `out` in a single pass.
+/// Works two samples per iteration so the swap costs nothing extra and the loop body maps onto dual-MAC/SIMD units.
+/// Each pair is read before it is written, so `out` may alias `in` when processing in place, or when widening with the
+/// input packed at the tail of the output buffer.
+template<typename InT, typename OutT, int Shift>
+inline void fused_output(const InT *in, OutT *out, size_t samples, const OutputKernelParams &params) {
+  const size_t pairs = samples / 2;
+  const int32_t gain = params.q31_gain;
+
+  if (gain == INT32_MAX) {
+    if (params.swap_pairs) {
+      for (size_t i = 0; i < pairs; ++i) {
+        const int32_t a = in[2 * i];
+        const int32_t b = in[2 * i + 1];
+        out[2 * i] = static_cast<OutT>(static_cast<uint32_t>(b) << Shift);
+        out[2 * i + 1] = static_cast<OutT>(static_cast<uint32_t>(a) << Shift);
+      }
+    } else {
+      for (size_t i = 0; i < pairs; ++i) {
+        const int32_t a = in[2 * i];
+        const int32_t b = in[2 * i + 1];
+        out[2 * i] = static_cast<OutT>(static_cast<uint32_t>(a) << Shift);
+        out[2 * i + 1] = static_cast<OutT>(static_cast<uint32_t>(b) << Shift);
+      }
+    }
+  } else {
+    if (params.swap_pairs) {
+      for (size_t i = 0; i < pairs; ++i) {
+        const int32_t a = scale<Shift>(in[2 * i], gain);
+        const int32_t b = scale<Shift>(in[2 * i + 1], gain);
+        out[2 * i] = static_cast<OutT>(b);
+        out[2 * i + 1] = static_cast<OutT>(a);
+      }
+    } else {
+      for (size_t i = 0; i < pairs; ++i) {
+        const int32_t a = scale<Shift>(in[2 * i], gain);
+        const int32_t b = scale<Shift>(in[2 * i + 1], gain);
+        out[2 * i] = static_cast<OutT>(a);
+        out[2 * i + 1] = static_cast<OutT>(b);
+      }
+    }
+  }
+
+  if (samples & 1) {
+    // A trailing unpaired sample is never swapped, matching the previous multi-pass behavior
+    const int32_t s = in[samples - 1];
+    out[samples - 1] = static_cast<OutT>(gain == INT32_MAX ? static_cast<int32_t>(static_cast<uint32_t>(s) << Shift)
+                                                           : scale<Shift>(s, gain));
+  }
+}
+
+/// @brief Loads a little-endian packed sample of `Bytes` width as a left-justified Q31 value. 8-bit PCM is unsigned
+/// offset binary, so its midpoint 0x80 is silence.
+template<size_t Bytes> inline int32_t load_q31(const uint8_t *p);
+template<> inline int32_t load_q31<1>(const uint8_t *p) {
+  return static_cast<int32_t>(static_cast<uint32_t>(p[0] ^ 0x80) << 24);
+}
+template<> inline int32_t load_q31<2>(const uint8_t *p) {
+  return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 24));
+}
+template<> inline int32_t load_q31<3>(const uint8_t *p) {
+  return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) |
+                              (static_cast<uint32_t>(p[2]) << 24));
+}
+template<> inline int32_t load_q31<4>(const uint8_t *p) {
+  return static_cast<int32_t>(static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                              (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24));
+}
+
+/// @brief Stores the most significant `Bytes` of a Q31 value as a little-endian packed sample. Stores only fill I2S
+/// slots, which are two's complement at every width (the zeros the driver fills an underflow with are silence), so
+/// unlike load_q31() an 8-bit store stays signed.
+template<size_t Bytes> inline void store_q31(int32_t value, uint8_t *p) {
+  const uint32_t v = static_cast<uint32_t>(value);
+  for (size_t b = 0; b < Bytes; ++b) {
+    p[b] = static_cast<uint8_t>(v >> (8 * (4 - Bytes + b)));
+  }
+}
+
+/// @brief Generic fused converter for any pair of packed sample widths (8, 16, 24 or 32 bits). Samples are lifted to
+/// Q31, scaled, optionally pair-swapped, and truncated or widened to the output width in one pass. Aliasing rules match
+/// fused_output(): in place, narrowing into the head of the buffer, or widening from input packed at the tail.
+template<size_t InBytes, size_t OutBytes>
+inline void convert_output(const uint8_t *in, uint8_t *out, size_t samples, const OutputKernelParams &params) {
+  const size_t pairs = samples / 2;
+  const int32_t gain = params.q31_gain;
+  const size_t first = params.swap_pairs ? 1 : 0;
+
+  for (size_t i = 0; i < pairs; ++i) {
+    int32_t a = load_q31<InBytes>(in + (2 * i) * InBytes);
+    int32_t b = load_q31<InBytes>(in + (2 * i + 1) * InBytes);
+    if (gain != INT32_MAX) {
+      a = scale<0>(a, gain);
+      b = scale<0>(b, gain);
+    }
+    store_q31<OutBytes>(a, out + (2 * i + first) * OutBytes);
+    store_q31<OutBytes>(b, out + (2 * i + 1 - first) * OutBytes);
+  }
+
+  if (samples & 1) {
+    int32_t s = load_q31<InBytes>(in + (samples - 1) * InBytes);
+    if (gain != INT32_MAX) {
+      s = scale<0>(s, gain);
+    }
+    store_q31<OutBytes>(s, out + (samples - 1) * OutBytes);
+  }
+}
+
+/// @brief Generic converter with a linear gain ramp, used while a duck is fading in or out. Matches convert_output()
+/// except that the gain moves by `q31_gain_step` after each of the first `ramp_pairs` sample pairs.
+template<size_t InBytes, size_t OutBytes>
+inline void ramp_output(const uint8_t *in, uint8_t *out, size_t samples, const OutputKernelParams &params) {
+  const size_t pairs = samples / 2;
+  const size_t ramp_pairs = std::min<size_t>(pairs, params.ramp_pairs);
+  const size_t first = params.swap_pairs ? 1 : 0;
+  int32_t gain = params.q31_gain;
+
+  for (size_t i = 0; i < pairs; ++i) {
+    const int32_t a = scale<0>(load_q31<InBytes>(in + (2 * i) * InBytes), gain);
+    const int32_t b = scale<0>(load_q31<InBytes>(in + (2 * i + 1) * InBytes), gain);
+    store_q31<OutBytes>(a, out + (2 * i + first) * OutBytes);
+    store_q31<OutBytes>(b, out + (2 * i + 1 - first) * OutBytes);
+    if (i < ramp_pairs) {
+      gain += params.q31_gain_step;
+    }
+  }
+
+  if (samples & 1) {
+    store_q31<OutBytes>(scale<0>(load_q31<InBytes>(in + (samples - 1) * InBytes), gain),
+                        out + (samples - 1) * OutBytes);
+  }
+}
+
+/// @brief Byte-pointer adapter so the typed fast paths share the OutputKernel signature.
+template<typename InT, typename OutT, int Shift>
+inline void fused_output_bytes(const uint8_t *in, uint8_t *out, size_t samples, const OutputKernelParams &params) {
+  fused_output<InT, OutT, Shift>(reinterpret_cast<const InT *>(in), reinterpret_cast<OutT *>(out), samples, params);
+}
+
+/// @brief Returns the kernel converting `in_bytes` wide stream samples into `out_bytes` wide DMA samples, or nullptr
+/// if either width is unsupported. The aligned 16/32-bit combinations use the typed fast paths.
+inline OutputKernel select_output_kernel(size_t in_bytes, size_t out_bytes) {
+  if (in_bytes == 2 && out_bytes == 2) {
+    return &fused_output_bytes<int16_t, int16_t, 0>;
+  }
+  if (in_bytes == 2 && out_bytes == 4) {
+    return &fused_output_bytes<int16_t, int32_t, 16>;
+  }
+  if (in_bytes == 4 && out_bytes == 4) {
+    return &fused_output_bytes<int32_t, int32_t, 0>;
+  }
+  if (in_bytes < 1 || in_bytes > 4 || out_bytes < 1 || out_bytes > 4) {
+    return nullptr;
+  }
+
+  static constexpr OutputKernel GENERIC_KERNELS[4][4] = {
+      {&convert_output<1, 1>, &convert_output<1, 2>, &convert_output<1, 3>, &convert_output<1, 4>},
+      {&convert_output<2, 1>, &convert_output<2, 2>, &convert_output<2, 3>, &convert_output<2, 4>},
+      {&convert_output<3, 1>, &convert_output<3, 2>, &convert_output<3, 3>, &convert_output<3, 4>},
+      {&convert_output<4, 1>, &convert_output<4, 2>, &convert_output<4, 3>, &convert_output<4, 4>},
+  };
+  return GENERIC_KERNELS[in_bytes - 1][out_bytes - 1];
+}
+
+/// @brief Returns the gain-ramp kernel for the given widths, or nullptr if either width is unsupported.
+inline OutputKernel select_ramp_output_kernel(size_t in_bytes, size_t out_bytes) {
+  if (in_bytes < 1 || in_bytes > 4 || out_bytes < 1 || out_bytes > 4) {
+    return nullptr;
+  }
+
+  static constexpr OutputKernel RAMP_KERNELS[4][4] = {
+      {&ramp_output<1, 1>, &ramp_output<1, 2>, &ramp_output<1, 3>, &ramp_output<1, 4>},
+      {&ramp_output<2, 1>, &ramp_output<2, 2>, &ramp_output<2, 3>, &ramp_output<2, 4>},
+      {&ramp_output<3, 1>, &ramp_output<3, 2>, &ramp_output<3, 3>, &ramp_output<3, 4>},
+      {&ramp_output<4, 1>, &ramp_output<4, 2>, &ramp_output<4, 3>, &ramp_output<4, 4>},
+  };
+  return RAMP_KERNELS[in_bytes - 1][out_bytes - 1];
+}
+
+}  // namespace kernels
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
@@ -3,19 +3,21 @@
 #ifdef USE_ESP32
 
 #include "esphome/components/audio/audio.h"
-#include "esphome/components/audio/audio_transfer_buffer.h"
 
 #include "esphome/core/hal.h"
 #include "esphome/core/log.h"
 
 #include "esp_timer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 namespace esphome::i2s_audio {
 
 static const char *const TAG = "i2s_audio.speaker.std";
 
 static constexpr size_t DMA_BUFFERS_COUNT = 4;
-static constexpr size_t I2S_EVENT_QUEUE_COUNT = DMA_BUFFERS_COUNT + 1;
 
 void I2SAudioSpeaker::dump_config() {
   I2SAudioSpeakerBase::dump_config();
@@ -67,149 +69,350 @@ void I2SAudioSpeaker::run_speaker_task() {
 
   const size_t ring_buffer_size = this->current_stream_info_.ms_to_bytes(ring_buffer_duration);
 
-  // When the I2S slot width exceeds the stream bit depth (e.g., 32-bit I2S with 16-bit
-  // audio), each sample must be expanded before writing so the DMA sees the correct number
-  // of bytes per frame.  Only the 2× case (16-bit → 32-bit) is supported; other ratios
-  // are rejected by start_i2s_driver() before the task reaches this point.
-  const uint8_t expand_factor = this->i2s_bits_per_sample() / this->current_stream_info_.get_bits_per_sample();
+  // The I2S slot width may differ from the stream bit depth (e.g., 32-bit I2S with 16-bit audio). Samples are
+  // widened or narrowed while they are converted, so the DMA always sees whole slot-width frames. Raw stream audio is
+  // converted straight out of the ring buffer into the output buffer, which holds DMA-format audio produced by the
+  // fused volume/swap/conversion kernel. Raw audio is converted exactly once, so partial DMA writes never re-process
+  // samples.
+  // The output format only depends on the I2S slots, so it stays the same when the stream format changes in place
+  const size_t output_buffer_size = this->output_bytes_(bytes_to_fill_single_dma_buffer);
+  const size_t output_bytes_per_frame = this->output_bytes_(this->current_stream_info_.frames_to_bytes(1));
+  // Convert whole sample pairs so the ESP32 mono swap never straddles two blocks
+  size_t process_granularity = this->current_stream_info_.samples_to_bytes(2);
+  const uint32_t frame_granularity = (this->current_stream_info_.get_channels() == 1) ? 2 : 1;
 
   bool successful_setup = false;
-  std::unique_ptr<audio::AudioSourceTransferBuffer> transfer_buffer =
-      audio::AudioSourceTransferBuffer::create(bytes_to_fill_single_dma_buffer);
-  std::unique_ptr<uint8_t[]> expansion_buffer;
-  if (expand_factor > 1) {
-    expansion_buffer = std::make_unique<uint8_t[]>(bytes_to_fill_single_dma_buffer * expand_factor);
-  }
-
-  if (transfer_buffer != nullptr && (expand_factor == 1 || expansion_buffer != nullptr)) {
-    std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = ring_buffer::RingBuffer::create(ring_buffer_size);
-    if (temp_ring_buffer.use_count() == 1) {
-      transfer_buffer->set_source(temp_ring_buffer);
-      this->audio_ring_buffer_ = temp_ring_buffer;  // assign to base weak_ptr
+  std::shared_ptr<audio_ring::AudioRing> audio_ring_buffer =
+      audio_ring::AudioRing::create(ring_buffer_size, this->current_stream_info_.frames_to_bytes(1));
+  std::unique_ptr<uint8_t[]> output_buffer;
+  size_t output_length = 0;
+
+  if (audio_ring_buffer != nullptr) {
+    if (this->direct_dma_write_) {
+      // Audio is converted straight from the ring buffer into DMA descriptors; no staging buffers are needed
       successful_setup = true;
+    } else {
+      output_buffer = std::make_unique<uint8_t[]>(output_buffer_size);
+      successful_setup = output_buffer != nullptr;
     }
   }
 
+  if (successful_setup) {
+    this->reset_schedule_();
+    LockGuard lock(this->stream_lock_);
+    this->audio_ring_buffer_ = audio_ring_buffer;  // assign to base weak_ptr
+  }
+
   if (!successful_setup) {
     xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::ERR_ESP_NO_MEM);
+  } else if (this->direct_dma_write_) {
+    // A task woken from standby runs the loop again on the same ring buffer and channel
+    while (this->run_direct_dma_loop_(audio_ring_buffer, ring_buffer_duration) &&
+           this->park_in_standby_(audio_ring_buffer.get())) {
+    }
   } else {
-    bool stop_gracefully = false;
-    bool tx_dma_underflow = true;
-
-    uint32_t frames_written = 0;
-    uint32_t last_data_received_time = millis();
-
-    xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::TASK_RUNNING);
+    bool can_park = true;
+    do {
+      bool stop_gracefully = false;
+      bool tx_dma_underflow = true;
+
+      uint32_t frames_written = 0;
+      uint32_t last_data_received_time = millis();
+      // Time from which the frames_written frames queued in the DMA play back to back
+      int64_t dma_anchor_us = esp_timer_get_time();
+      // Silence queued for a play_at() schedule, and how many queued frames precede it; it is not reported as played
+      uint32_t padding_offset_frames = 0;
+      uint32_t padding_frames = 0;
+
+      // Seamless underflow state: once the channel is running it is never stopped; descriptors the DMA was already
+      // sending as silence when writing resumed finish before silence_until_us and carry none of frames_written
+      const uint32_t dma_buffer_us =
+          this->current_stream_info_.frames_to_microseconds(frames_to_fill_single_dma_buffer);
+      bool channel_running = false;
+      int64_t last_event_us = 0;
+      int64_t silence_until_us = 0;
+      // Set once the stream has played, so the DMA running dry from then on waits for the resume watermark
+      bool playback_started = false;
+      // Audio the DSP chain still holds once the stream ends, flushed behind its last frame; like the schedule
+      // padding, it is not reported as played
+      uint32_t dsp_tail_left = this->dsp_tail_frames_();
+      uint32_t tail_offset_frames = 0;
+      uint32_t tail_frames = 0;
+      this->sync_reset_();
+      this->dsp_.reset();
+
+      xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::TASK_RUNNING);
+
+      while (this->pause_state_ || !this->timeout_.has_value() ||
+             (millis() - last_data_received_time) <= this->timeout_.value()) {
+        uint32_t event_group_bits = xEventGroupGetBits(this->event_group_);
+
+        if (event_group_bits & SpeakerEventGroupBits::COMMAND_STOP) {
+          xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::COMMAND_STOP);
+          ESP_LOGV(TAG, "Exiting: COMMAND_STOP received");
+          break;
+        }
+        if ((event_group_bits & SpeakerEventGroupBits::COMMAND_STOP_GRACEFULLY) && this->take_stream_end_()) {
+          stop_gracefully = true;
+        }
+        if (stop_gracefully && this->stream_chained_()) {
+          // Another stream was queued before this one drained; it continues on the same DMA timeline
+          stop_gracefully = false;
+        }
 
-    while (this->pause_state_ || !this->timeout_.has_value() ||
-           (millis() - last_data_received_time) <= this->timeout_.value()) {
-      uint32_t event_group_bits = xEventGroupGetBits(this->event_group_);
+        if ((this->audio_stream_info_ != this->current_stream_info_) && (audio_ring_buffer->available() == 0)) {
+          // Every byte of the old stream has been converted; play() holds back audio in the new format until here
+          if (!this->reconfigure_stream_(audio_ring_buffer, ring_buffer_duration)) {
+            ESP_LOGV(TAG, "Exiting: stream info changed");
+            can_park = false;
+            break;
+          }
+          process_granularity = this->current_stream_info_.samples_to_bytes(2);
+        }
 
-      if (event_group_bits & SpeakerEventGroupBits::COMMAND_STOP) {
-        xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::COMMAND_STOP);
-        ESP_LOGV(TAG, "Exiting: COMMAND_STOP received");
-        break;
-      }
-      if (event_group_bits & SpeakerEventGroupBits::COMMAND_STOP_GRACEFULLY) {
-        xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::COMMAND_STOP_GRACEFULLY);
-        stop_gracefully = true;
-      }
+        DmaEvent dma_event;
+        uint32_t missed_events = 0;
+        const ProfileMark drain_mark = this->profile_mark_();
+        while (this->dma_events_.pop(dma_event, missed_events)) {
+          if (missed_events > 0) {
+            this->missed_dma_events_.fetch_add(missed_events, std::memory_order_relaxed);
+          }
+          // Completions the ring overwrote were descriptors sent one buffer apart before this one; account for them in
+          // order exactly as if they had been read
+          for (int64_t replay = missed_events; replay >= 0; --replay) {
+            const int64_t event_timestamp = dma_event.timestamp - replay * dma_buffer_us;
+            last_event_us = event_timestamp;
+            if (event_timestamp < silence_until_us) {
+              continue;
+            }
+
+            int64_t write_timestamp = event_timestamp;
+            uint32_t frames_sent = frames_to_fill_single_dma_buffer;
+            if (frames_to_fill_single_dma_buffer > frames_written) {
+              if (!tx_dma_underflow && !stop_gracefully && !this->pause_state_) {
+                this->record_underflow_();
+              }
+              tx_dma_underflow = true;
+              frames_sent = frames_written;
+              const uint32_t frames_zeroed = frames_to_fill_single_dma_buffer - frames_written;
+              write_timestamp -= this->current_stream_info_.frames_to_microseconds(frames_zeroed);
+            } else {
+              tx_dma_underflow = false;
+            }
+            frames_written -= frames_sent;
+            dma_anchor_us = event_timestamp;
+            this->sync_update_(event_timestamp, frames_sent, frames_to_fill_single_dma_buffer);
+
+            uint32_t padding_sent = 0;
+            if ((padding_frames > 0) && (frames_sent > padding_offset_frames)) {
+              padding_sent = std::min(frames_sent - padding_offset_frames, padding_frames);
+              padding_frames -= padding_sent;
+            }
+            padding_offset_frames -= std::min(padding_offset_frames, frames_sent);
+
+            uint32_t tail_sent = 0;
+            if ((tail_frames > 0) && (frames_sent > tail_offset_frames)) {
+              // The tail follows the stream's last frame, which therefore finished that much earlier
+              tail_sent = std::min(frames_sent - tail_offset_frames, tail_frames);
+              tail_frames -= tail_sent;
+              write_timestamp -= this->current_stream_info_.frames_to_microseconds(tail_sent);
+            }
+            tail_offset_frames -= std::min(tail_offset_frames, frames_sent);
+
+            if (frames_sent > padding_sent + tail_sent) {
+              this->audio_output_callback_(frames_sent - padding_sent - tail_sent, write_timestamp);
+            }
+          }
+        }
+        this->profile_record_(PHASE_DRAIN, drain_mark);
 
-      if (this->audio_stream_info_ != this->current_stream_info_) {
-        ESP_LOGV(TAG, "Exiting: stream info changed");
-        break;
-      }
+        this->publish_playback_timing_(
+            dma_anchor_us + this->current_stream_info_.frames_to_microseconds(frames_written), 0,
+            output_length / output_bytes_per_frame);
 
-      int64_t write_timestamp;
-      while (xQueueReceive(this->i2s_event_queue_, &write_timestamp, 0)) {
-        uint32_t frames_sent = frames_to_fill_single_dma_buffer;
-        if (frames_to_fill_single_dma_buffer > frames_written) {
-          tx_dma_underflow = true;
-          frames_sent = frames_written;
-          const uint32_t frames_zeroed = frames_to_fill_single_dma_buffer - frames_written;
-          write_timestamp -= this->current_stream_info_.frames_to_microseconds(frames_zeroed);
-        } else {
-          tx_dma_underflow = false;
+        if (this->pause_state_) {
+          vTaskDelay(pdMS_TO_TICKS(actual_dma_buffer_ms));
+          continue;
         }
-        frames_written -= frames_sent;
-        if (frames_sent > 0) {
-          this->audio_output_callback_(frames_sent, write_timestamp);
-        }
-      }
 
-      if (this->pause_state_) {
-        vTaskDelay(pdMS_TO_TICKS(actual_dma_buffer_ms));
-        continue;
-      }
+        const uint32_t read_delay = (this->current_stream_info_.frames_to_microseconds(frames_written) / 1000) / 2;
 
-      const uint32_t read_delay = (this->current_stream_info_.frames_to_microseconds(frames_written) / 1000) / 2;
+        // The producer's commit wakes the task as soon as a descriptor's worth of audio is buffered
+        const ProfileMark transfer_mark = this->profile_mark_();
+        audio_ring_buffer->wait_for_available(frames_to_fill_single_dma_buffer, pdMS_TO_TICKS(read_delay));
+        this->profile_record_(PHASE_TRANSFER, transfer_mark);
 
-      size_t bytes_read = transfer_buffer->transfer_data_from_source(pdMS_TO_TICKS(read_delay));
-      uint8_t *new_data = transfer_buffer->get_buffer_end() - bytes_read;
+        const int32_t sync_frames = this->sync_pending_frames_();
+        if ((sync_frames < 0) && (audio_ring_buffer->available_frames() >= static_cast<uint32_t>(-sync_frames))) {
+          audio_ring_buffer->commit_read(-sync_frames);
+          this->stream_bytes_consumed_ += this->current_stream_info_.frames_to_bytes(-sync_frames);
+          this->sync_correction_applied_();
+        }
 
-      if (bytes_read > 0) {
-        this->apply_software_volume_(new_data, bytes_read);
-        this->swap_esp32_mono_samples_(new_data, bytes_read);
-      }
+        // Convert as much raw audio as fits in the output buffer, in whole frames of the output format, straight out
+        // of the ring buffer. A sample pair split by the end of the ring is made contiguous.
+        const uint32_t output_frames_free = (output_buffer_size - output_length) / output_bytes_per_frame;
+        size_t run_frames = 0;
+        const uint8_t *run = audio_ring_buffer->acquire_read(run_frames, frame_granularity);
+        size_t bytes_to_process =
+            this->current_stream_info_.frames_to_bytes(std::min<uint32_t>(run_frames, output_frames_free));
+
+        const uint32_t frames_queued = frames_written + output_length / output_bytes_per_frame;
+        const int64_t next_frame_us = (tx_dma_underflow ? esp_timer_get_time() : dma_anchor_us) +
+                                      this->current_stream_info_.frames_to_microseconds(frames_queued);
+        this->track_stream_boundary_(next_frame_us, bytes_to_process);
+        const int32_t schedule_frames = this->schedule_offset_frames_(next_frame_us, bytes_to_process);
+        if (schedule_frames > 0) {
+          // The scheduled clip is early; queue silence in front of it
+          uint32_t silence_frames = std::min<uint32_t>(schedule_frames, output_frames_free);
+          silence_frames -= silence_frames % frame_granularity;
+          if (silence_frames > 0) {
+            if (padding_frames == 0) {
+              padding_offset_frames = frames_queued;
+            }
+            padding_frames += silence_frames;
+            std::memset(output_buffer.get() + output_length, 0, silence_frames * output_bytes_per_frame);
+            output_length += silence_frames * output_bytes_per_frame;
+          }
+        } else if (schedule_frames < 0) {
+          // The scheduled clip is late; drop its start so the rest plays on time
+          uint32_t skip_frames = std::min<uint32_t>(-schedule_frames, audio_ring_buffer->available_frames());
+          skip_frames -= skip_frames % frame_granularity;
+          audio_ring_buffer->commit_read(skip_frames);
+          this->schedule_skip_(skip_frames);
+        }
 
-      if (transfer_buffer->available() == 0) {
-        if (stop_gracefully && tx_dma_underflow) {
-          break;
+        bytes_to_process -= bytes_to_process % process_granularity;
+        if (bytes_to_process > 0) {
+          const ProfileMark convert_mark = this->profile_mark_();
+          output_length += this->process_output_(run, output_buffer.get() + output_length, bytes_to_process);
+          this->profile_record_(PHASE_CONVERT, convert_mark);
+          audio_ring_buffer->commit_read(this->current_stream_info_.bytes_to_frames(bytes_to_process));
+          this->stream_bytes_consumed_ += bytes_to_process;
         }
-        vTaskDelay(pdMS_TO_TICKS(actual_dma_buffer_ms / 2 + 1));
-      } else {
-        size_t bytes_written = 0;
-        i2s_chan_handle_t handle = this->parent_->get_tx_handle();
-
-        const void *write_ptr = transfer_buffer->get_buffer_start();
-        size_t write_size = transfer_buffer->available();
-
-        if (expand_factor == 2) {
-          const int16_t *in = reinterpret_cast<const int16_t *>(write_ptr);
-          int32_t *out = reinterpret_cast<int32_t *>(expansion_buffer.get());
-          const size_t samples = write_size / sizeof(int16_t);
-          for (size_t s = 0; s < samples; ++s) {
-            out[s] = static_cast<int32_t>(in[s]) << 16;
+
+        if (stop_gracefully && (dsp_tail_left > 0) && (audio_ring_buffer->available() == 0)) {
+          // The limiter still holds the stream's last frames in its look-ahead; push silence through to play them
+          uint32_t flush_frames =
+              std::min<uint32_t>(dsp_tail_left, (output_buffer_size - output_length) / output_bytes_per_frame);
+          flush_frames -= flush_frames % frame_granularity;
+          if (flush_frames > 0) {
+            if (tail_frames == 0) {
+              tail_offset_frames = frames_written + output_length / output_bytes_per_frame;
+            }
+            tail_frames += flush_frames;
+            output_length += this->flush_dsp_(output_buffer.get() + output_length, flush_frames);
+            dsp_tail_left -= flush_frames;
           }
-          write_ptr = expansion_buffer.get();
-          write_size = samples * sizeof(int32_t);
         }
 
-        if (tx_dma_underflow) {
-          // Disable channel and clear callback to reset the DMA buffer queue,
-          // then preload data so timing callbacks are accurate when re-enabled.
-          i2s_channel_disable(handle);
-          const i2s_event_callbacks_t null_callbacks = {.on_sent = nullptr};
-          i2s_channel_register_event_callback(handle, &null_callbacks, this);
-          i2s_channel_preload_data(handle, write_ptr, write_size, &bytes_written);
-        } else {
-          i2s_channel_write(handle, write_ptr, write_size, &bytes_written, actual_dma_buffer_ms);
+        if (sync_frames > 0) {
+          // Repeat the most recent converted frames to let the reference clock catch up
+          const size_t repeat_bytes = sync_frames * output_bytes_per_frame;
+          if ((output_length >= repeat_bytes) && (output_length + repeat_bytes <= output_buffer_size)) {
+            std::memcpy(output_buffer.get() + output_length, output_buffer.get() + output_length - repeat_bytes,
+                        repeat_bytes);
+            output_length += repeat_bytes;
+            this->sync_correction_applied_();
+          }
         }
 
-        bytes_written /= expand_factor;  // normalize back to stream-byte units
-
-        if (bytes_written > 0) {
-          last_data_received_time = millis();
-          frames_written += this->current_stream_info_.bytes_to_frames(bytes_written);
-          transfer_buffer->decrease_buffer_length(bytes_written);
+        // Seamless mode hands the driver whole descriptors only, so a resumed stream always starts on a descriptor
+        // boundary and never continues a descriptor that already played. A short tail is flushed when finishing.
+        const bool seamless_resume = this->seamless_underflow_ && channel_running;
+        const bool hold_partial = this->seamless_underflow_ && (output_length < output_buffer_size) &&
+                                  !(stop_gracefully && (audio_ring_buffer->available() == 0));
+
+        // A starting or underflowed stream waits until enough audio is buffered to ride out the source's jitter. A full
+        // ring buffer always releases it.
+        bool hold_watermark = false;
+        if (tx_dma_underflow && !stop_gracefully && (audio_ring_buffer->free() > 0)) {
+          const uint32_t buffered_frames =
+              audio_ring_buffer->available_frames() + output_length / output_bytes_per_frame;
+          hold_watermark = this->current_stream_info_.frames_to_microseconds(buffered_frames) <
+                           this->watermark_ms_(playback_started) * 1000;
+        }
 
-          if (tx_dma_underflow) {
-            tx_dma_underflow = false;
-            xQueueReset(this->i2s_event_queue_);
-            const i2s_event_callbacks_t callbacks = {.on_sent = i2s_on_sent_cb};
-            i2s_channel_register_event_callback(handle, &callbacks, this);
-            i2s_channel_enable(handle);
+        if ((output_length == 0) || hold_partial || hold_watermark) {
+          if (stop_gracefully && tx_dma_underflow && (output_length == 0)) {
+            break;
+          }
+          vTaskDelay(pdMS_TO_TICKS(actual_dma_buffer_ms / 2 + 1));
+        } else {
+          size_t bytes_written = 0;
+          i2s_chan_handle_t handle = this->parent_->get_tx_handle();
+
+          const ProfileMark write_mark = this->profile_mark_();
+          if (tx_dma_underflow && !seamless_resume) {
+            // Disable channel and clear callback to reset the DMA buffer queue,
+            // then preload data so timing callbacks are accurate when re-enabled.
+            i2s_channel_disable(handle);
+            const i2s_event_callbacks_t null_callbacks = {.on_sent = nullptr};
+            i2s_channel_register_event_callback(handle, &null_callbacks, this);
+            i2s_channel_preload_data(handle, output_buffer.get(), output_length, &bytes_written);
+          } else {
+            if (!tx_dma_underflow) {
+              this->profile_margin_(dma_anchor_us + this->current_stream_info_.frames_to_microseconds(frames_written));
+            }
+            i2s_channel_write(handle, output_buffer.get(), output_length, &bytes_written, actual_dma_buffer_ms);
+          }
+          this->profile_record_(PHASE_WRITE, write_mark);
+
+          if (bytes_written > 0) {
+            last_data_received_time = millis();
+            const uint32_t frames_sent_to_dma = bytes_written / output_bytes_per_frame;
+            frames_written += frames_sent_to_dma;
+            playback_started = true;
+
+            if (tx_dma_underflow && seamless_resume) {
+              // The driver hands out the descriptor queued right behind the one playing now, so the audio starts at
+              // the next descriptor boundary after the last completion
+              tx_dma_underflow = false;
+              const int64_t boundaries_passed = (esp_timer_get_time() - last_event_us) / dma_buffer_us + 1;
+              dma_anchor_us = last_event_us + boundaries_passed * dma_buffer_us;
+              silence_until_us = dma_anchor_us + dma_buffer_us / 2;
+              this->record_first_sample_(dma_anchor_us);
+            } else if (tx_dma_underflow) {
+              tx_dma_underflow = false;
+              this->dma_events_.reset();
+              const i2s_event_callbacks_t callbacks = {.on_sent = i2s_on_sent_cb};
+              i2s_channel_register_event_callback(handle, &callbacks, this);
+              i2s_channel_enable(handle);
+              dma_anchor_us = esp_timer_get_time();
+              last_event_us = dma_anchor_us;
+              channel_running = true;
+              this->record_first_sample_(dma_anchor_us);
+            }
+
+            // The frames just written are the last ones queued, so they play right before the DMA queue ends
+            const int64_t dma_queue_end_us =
+                dma_anchor_us + this->current_stream_info_.frames_to_microseconds(frames_written);
+            this->tap_played_audio_(output_buffer.get(), bytes_written,
+                                    dma_queue_end_us -
+                                        this->current_stream_info_.frames_to_microseconds(frames_sent_to_dma));
+
+            output_length -= bytes_written;
+            if (output_length > 0) {
+              std::memmove(output_buffer.get(), output_buffer.get() + bytes_written, output_length);
+            }
+
+            this->publish_playback_timing_(
+                dma_anchor_us + this->current_stream_info_.frames_to_microseconds(frames_written), 0,
+                output_length / output_bytes_per_frame);
           }
         }
       }
-    }
+      output_length = 0;
+    } while (can_park && this->park_in_standby_(audio_ring_buffer.get()));
   }
 
+  this->publish_playback_timing_(0, 0, 0);
+
   xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::TASK_STOPPING);
 
-  if (transfer_buffer != nullptr) {
-    transfer_buffer.reset();
-  }
+  // The task is deleted rather than returning, so nothing on its stack is destroyed unless released here
+  output_buffer.reset();
+  audio_ring_buffer.reset();
 
   xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::TASK_STOPPED);
 
@@ -218,24 +421,335 @@ void I2SAudioSpeaker::run_speaker_task() {
   }
 }
 
+bool I2SAudioSpeaker::run_direct_dma_loop_(std::shared_ptr<audio_ring::AudioRing> &audio_ring_buffer,
+                                           uint32_t ring_buffer_duration_ms) {
+  const uint32_t frames_per_dma_buffer = this->get_dma_buffer_length();
+  const uint32_t dma_buffer_ms = this->current_stream_info_.frames_to_microseconds(frames_per_dma_buffer) / 1000;
+
+  // Frames written into each descriptor. The DMA sends its descriptors in a fixed cycle, so a completion's sequence
+  // number identifies its descriptor even when the completions before it were missed.
+  std::vector<DmaSlot> slots(this->get_dma_buffer_count());
+  uint32_t frames_in_flight = 0;
+
+  // A descriptor refilled when it is reported sent plays after every other descriptor has been sent once more
+  const uint32_t dma_buffer_us = this->current_stream_info_.frames_to_microseconds(frames_per_dma_buffer);
+  const int64_t dma_refill_lead_us = static_cast<int64_t>(dma_buffer_us) * (slots.size() - 1);
+  int64_t dma_queue_end_us = 0;
+
+  bool stop_gracefully = false;
+  bool can_park = true;
+  uint32_t last_data_received_time = millis();
+
+  // Descriptors stay silent until the ring buffer reaches the start watermark, and again after an underflow until it
+  // reaches the resume watermark
+  bool waiting_for_watermark = true;
+  bool playback_started = false;
+  bool dma_full = false;  // the last refilled descriptor was full
+
+  // Let the channel free-run on driver-cleared silence; every descriptor it reports as sent is refilled in place
+  i2s_chan_handle_t handle = this->parent_->get_tx_handle();
+  i2s_channel_disable(handle);
+  this->dma_events_.reset();
+  this->dma_event_waiter_.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+  const i2s_event_callbacks_t callbacks = {.on_sent = i2s_on_sent_cb};
+  i2s_channel_register_event_callback(handle, &callbacks, this);
+  i2s_channel_enable(handle);
+  this->sync_reset_();
+  this->dsp_.reset();
+  // Audio the DSP chain still holds once the stream ends, flushed into the descriptors behind its last frame
+  uint32_t dsp_tail_left = this->dsp_tail_frames_();
+
+  xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::TASK_RUNNING);
+
+  while (this->pause_state_ || !this->timeout_.has_value() ||
+         (millis() - last_data_received_time) <= this->timeout_.value()) {
+    uint32_t event_group_bits = xEventGroupGetBits(this->event_group_);
+
+    if (event_group_bits & SpeakerEventGroupBits::COMMAND_STOP) {
+      xEventGroupClearBits(this->event_group_, SpeakerEventGroupBits::COMMAND_STOP);
+      ESP_LOGV(TAG, "Exiting: COMMAND_STOP received");
+      break;
+    }
+    if ((event_group_bits & SpeakerEventGroupBits::COMMAND_STOP_GRACEFULLY) && this->take_stream_end_()) {
+      stop_gracefully = true;
+    }
+    if (stop_gracefully && this->stream_chained_()) {
+      // Another stream was queued before this one drained; it continues on the same DMA timeline
+      stop_gracefully = false;
+    }
+
+    if ((this->audio_stream_info_ != this->current_stream_info_) && (audio_ring_buffer->available() == 0) &&
+        !this->reconfigure_stream_(audio_ring_buffer, ring_buffer_duration_ms)) {
+      ESP_LOGV(TAG, "Exiting: stream info changed");
+      can_park = false;
+      break;
+    }
+
+    if (stop_gracefully && (frames_in_flight == 0) && (dsp_tail_left == 0) && (audio_ring_buffer->available() == 0)) {
+      break;
+    }
+
+    DmaEvent dma_event;
+    uint32_t missed_events = 0;
+    if (!this->dma_events_.pop(dma_event, missed_events)) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(2 * dma_buffer_ms));
+      continue;
+    }
+
+    const ProfileMark drain_mark = this->profile_mark_();
+    if (missed_events > 0) {
+      this->missed_dma_events_.fetch_add(missed_events, std::memory_order_relaxed);
+    }
+    for (uint32_t replay = missed_events; replay > 0; --replay) {
+      // These descriptors went out without the task seeing them. Report what they carried; the driver cleared them,
+      // so they play silence until their next completion is refilled.
+      DmaSlot &missed_slot = slots[(dma_event.sequence - replay) % slots.size()];
+      frames_in_flight -= this->complete_dma_slot_(missed_slot, dma_event.timestamp - replay * dma_buffer_us,
+                                                   frames_per_dma_buffer);
+    }
+
+    DmaSlot *slot = &slots[dma_event.sequence % slots.size()];
+    slot->dma_buf = dma_event.dma_buf;
+    frames_in_flight -= this->complete_dma_slot_(*slot, dma_event.timestamp, frames_per_dma_buffer);
+    this->profile_record_(PHASE_DRAIN, drain_mark);
+
+    if (this->pause_state_) {
+      continue;
+    }
+
+    if (waiting_for_watermark) {
+      const uint32_t buffered_us = this->current_stream_info_.frames_to_microseconds(
+          this->current_stream_info_.bytes_to_frames(audio_ring_buffer->available()));
+      waiting_for_watermark = !stop_gracefully && (audio_ring_buffer->free() > 0) &&
+                              (buffered_us < this->watermark_ms_(playback_started) * 1000);
+    }
+
+    if (!waiting_for_watermark) {
+      const ProfileMark convert_mark = this->profile_mark_();
+      this->fill_dma_buffer_(*slot, audio_ring_buffer.get(), frames_per_dma_buffer,
+                             dma_event.timestamp + dma_refill_lead_us);
+      if (stop_gracefully && (dsp_tail_left > 0) && (audio_ring_buffer->available() == 0)) {
+        dsp_tail_left -= this->flush_dsp_tail_(*slot, dsp_tail_left, frames_per_dma_buffer);
+      }
+      this->profile_record_(PHASE_CONVERT, convert_mark);
+      this->profile_margin_(dma_event.timestamp + dma_refill_lead_us);
+      if (slot->frames > 0) {
+        frames_in_flight += slot->frames;
+        last_data_received_time = millis();
+        dma_queue_end_us = dma_event.timestamp + dma_refill_lead_us +
+                           this->current_stream_info_.frames_to_microseconds(slot->frames);
+        this->record_first_sample_(dma_event.timestamp + dma_refill_lead_us);
+        this->tap_played_audio_(static_cast<const uint8_t *>(slot->dma_buf),
+                                this->output_bytes_(this->current_stream_info_.frames_to_bytes(slot->frames)),
+                                dma_event.timestamp + dma_refill_lead_us);
+      }
+      if (slot->frames < frames_per_dma_buffer) {
+        // The ring buffer ran dry
+        if (dma_full && !stop_gracefully) {
+          this->record_underflow_();
+        }
+        dma_full = false;
+        waiting_for_watermark = playback_started;
+      } else {
+        dma_full = true;
+        playback_started = true;
+      }
+    }
+
+    // The next descriptor is freed one buffer from now, and whatever goes into it plays after the others
+    this->publish_playback_timing_(dma_queue_end_us, dma_event.timestamp + dma_buffer_us + dma_refill_lead_us, 0);
+  }
+
+  this->dma_event_waiter_.store(nullptr, std::memory_order_relaxed);
+  return can_park;
+}
+
+bool I2SAudioSpeaker::park_in_standby_(audio_ring::AudioRing *audio_ring_buffer) {
+  if (!this->warm_standby_) {
+    return false;
+  }
+
+  // Keep the channel, its DMA descriptors, the task, and its buffers; only stop the clock
+  i2s_channel_disable(this->parent_->get_tx_handle());
+  audio_ring_buffer->reset();
+  this->dsp_.reset();
+  this->reset_schedule_();
+  this->publish_playback_timing_(0, 0, 0);
+  ESP_LOGV(TAG, "Standing by");
+  xEventGroupSetBits(this->event_group_, SpeakerEventGroupBits::TASK_STANDBY);
+
+  // Direct DMA completions may have left a stale notification; only the wake flag ends standby
+  while (!this->standby_wake_.exchange(false, std::memory_order_acquire)) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+  return true;
+}
+
+uint32_t I2SAudioSpeaker::complete_dma_slot_(DmaSlot &slot, int64_t sent_timestamp, uint32_t frames_per_dma_buffer) {
+  this->sync_update_(sent_timestamp, slot.frames, frames_per_dma_buffer);
+
+  if (slot.frames > slot.padding_frames + slot.tail_frames) {
+    // A partially filled descriptor's real frames finished before its trailing silence and DSP tail
+    const uint32_t frames_after = frames_per_dma_buffer - slot.frames + slot.tail_frames;
+    this->audio_output_callback_(slot.frames - slot.padding_frames - slot.tail_frames,
+                                 sent_timestamp - this->current_stream_info_.frames_to_microseconds(frames_after));
+  }
+
+  const uint32_t frames = slot.frames;
+  slot.frames = 0;
+  slot.padding_frames = 0;
+  slot.tail_frames = 0;
+  return frames;
+}
+
+uint32_t I2SAudioSpeaker::flush_dsp_tail_(DmaSlot &slot, uint32_t tail_frames, uint32_t frames_per_dma_buffer) {
+  uint32_t frames = std::min(tail_frames, frames_per_dma_buffer - slot.frames);
+  frames -= frames % ((this->current_stream_info_.get_channels() == 1) ? 2 : 1);
+  const size_t output_bytes_per_frame = this->output_bytes_(this->current_stream_info_.frames_to_bytes(1));
+  this->flush_dsp_(static_cast<uint8_t *>(slot.dma_buf) + slot.frames * output_bytes_per_frame, frames);
+  slot.frames += frames;
+  slot.tail_frames += frames;
+  return frames;
+}
+
+void I2SAudioSpeaker::fill_dma_buffer_(DmaSlot &slot, audio_ring::AudioRing *audio_ring_buffer,
+                                       uint32_t frames_per_dma_buffer, int64_t buffer_start_us) {
+  uint8_t *dma_buf = static_cast<uint8_t *>(slot.dma_buf);
+  const size_t input_bytes_per_frame = this->current_stream_info_.frames_to_bytes(1);
+  const size_t output_bytes_per_frame = this->output_bytes_(input_bytes_per_frame);
+  // Convert whole sample pairs so the ESP32 mono swap never straddles two blocks
+  const uint32_t frame_granularity = (this->current_stream_info_.get_channels() == 1) ? 2 : 1;
+
+  const int32_t sync_frames = this->sync_pending_frames_();
+  if ((sync_frames < 0) && (audio_ring_buffer->available_frames() >= static_cast<uint32_t>(-sync_frames))) {
+    audio_ring_buffer->commit_read(-sync_frames);
+    this->stream_bytes_consumed_ += this->current_stream_info_.frames_to_bytes(-sync_frames);
+    this->sync_correction_applied_();
+  }
+  // Leave room at the end of the descriptor for frames the drift tracker wants repeated
+  const uint32_t frames_to_fill = frames_per_dma_buffer - std::max<int32_t>(sync_frames, 0);
+
+  uint32_t frames_filled = 0;
+  uint32_t padding_frames = 0;
+  while (frames_filled < frames_to_fill) {
+    size_t stream_bytes = audio_ring_buffer->available();
+    const int64_t next_frame_us = buffer_start_us + this->current_stream_info_.frames_to_microseconds(frames_filled);
+    this->track_stream_boundary_(next_frame_us, stream_bytes);
+    const int32_t schedule_frames = this->schedule_offset_frames_(next_frame_us, stream_bytes);
+    if (schedule_frames > 0) {
+      // The scheduled clip is early; pad in front of it
+      uint32_t silence_frames = std::min<uint32_t>(schedule_frames, frames_to_fill - frames_filled);
+      silence_frames -= silence_frames % frame_granularity;
+      if (silence_frames == 0) {
+        break;
+      }
+      std::memset(dma_buf + frames_filled * output_bytes_per_frame, 0, silence_frames * output_bytes_per_frame);
+      frames_filled += silence_frames;
+      padding_frames += silence_frames;
+      continue;
+    }
+    if (schedule_frames < 0) {
+      // The scheduled clip is late; drop its start so the rest plays on time
+      uint32_t skip_frames = std::min<uint32_t>(-schedule_frames, audio_ring_buffer->available_frames());
+      skip_frames -= skip_frames % frame_granularity;
+      if (skip_frames == 0) {
+        break;
+      }
+      audio_ring_buffer->commit_read(skip_frames);
+      this->schedule_skip_(skip_frames);
+      continue;
+    }
+
+    // Converted straight out of the ring buffer; a sample pair split by the end of the ring is made contiguous
+    size_t run_frames = 0;
+    const uint8_t *input = audio_ring_buffer->acquire_read(run_frames, frame_granularity);
+    uint32_t frames = std::min<uint32_t>(frames_to_fill - frames_filled, stream_bytes / input_bytes_per_frame);
+    frames = std::min<uint32_t>(frames, run_frames);
+    frames -= frames % frame_granularity;
+    if (frames == 0) {
+      break;
+    }
+
+    const size_t input_bytes = frames * input_bytes_per_frame;
+    this->process_output_(input, dma_buf + frames_filled * output_bytes_per_frame, input_bytes);
+    audio_ring_buffer->commit_read(frames);
+    this->stream_bytes_consumed_ += input_bytes;
+    frames_filled += frames;
+  }
+
+  if ((sync_frames > 0) && (frames_filled == frames_to_fill) && (frames_filled >= static_cast<uint32_t>(sync_frames))) {
+    const size_t repeat_bytes = sync_frames * output_bytes_per_frame;
+    uint8_t *fill_end = dma_buf + frames_filled * output_bytes_per_frame;
+    std::memcpy(fill_end, fill_end - repeat_bytes, repeat_bytes);
+    frames_filled += sync_frames;
+    this->sync_correction_applied_();
+  }
+
+  slot.frames = frames_filled;
+  slot.padding_frames = padding_frames;
+}
+
+bool I2SAudioSpeaker::reconfigure_stream_(std::shared_ptr<audio_ring::AudioRing> &audio_ring_buffer,
+                                          uint32_t ring_buffer_duration_ms) {
+  const audio::AudioStreamInfo new_stream_info = this->audio_stream_info_;
+  if ((new_stream_info.get_sample_rate() != this->current_stream_info_.get_sample_rate()) ||
+      (new_stream_info.get_channels() != this->current_stream_info_.get_channels())) {
+    return false;
+  }
+  const uint8_t new_input_bytes = new_stream_info.samples_to_bytes(1);
+  if ((this->slot_bit_width_ == I2S_SLOT_BIT_WIDTH_AUTO) && (new_input_bytes != this->input_bytes_per_sample_)) {
+    return false;  // the slots were sized for the old bit depth
+  }
+  if (this->negotiate_data_bits_(new_stream_info) != this->data_bits_per_sample_) {
+    return false;  // the channel carries data words of the old width
+  }
+  if (kernels::select_output_kernel(new_input_bytes, this->output_bytes_per_sample_) == nullptr) {
+    return false;
+  }
+
+  // The ring buffer is empty at the stream boundary, so its free space is its capacity. play() leaves it alone until
+  // the two infos match again, so it can be reframed or swapped here and published together with the new info.
+  const size_t ring_buffer_size = new_stream_info.ms_to_bytes(ring_buffer_duration_ms);
+  audio_ring_buffer->set_frame_bytes(new_stream_info.frames_to_bytes(1));
+  if (audio_ring_buffer->free() < ring_buffer_size) {
+    std::shared_ptr<audio_ring::AudioRing> larger_ring_buffer =
+        audio_ring::AudioRing::create(ring_buffer_size, new_stream_info.frames_to_bytes(1));
+    if (larger_ring_buffer == nullptr) {
+      return false;
+    }
+    audio_ring_buffer = larger_ring_buffer;
+  }
+
+  ESP_LOGV(TAG, "Reconfiguring in place: %u -> %u bits per sample", this->current_stream_info_.get_bits_per_sample(),
+           new_stream_info.get_bits_per_sample());
+  {
+    LockGuard lock(this->stream_lock_);
+    this->audio_ring_buffer_ = audio_ring_buffer;
+    this->current_stream_info_ = new_stream_info;
+  }
+  return this->configure_output_kernel_();
+}
+
 esp_err_t I2SAudioSpeaker::start_i2s_driver(audio::AudioStreamInfo &audio_stream_info) {
-  this->current_stream_info_ = audio_stream_info;
+  {
+    LockGuard lock(this->stream_lock_);
+    this->current_stream_info_ = audio_stream_info;
+  }
 
   if (this->has_fixed_i2s_rate() && (this->sample_rate_ != audio_stream_info.get_sample_rate())) {
     ESP_LOGE(TAG, "Incompatible stream settings");
     return ESP_ERR_NOT_SUPPORTED;
   }
-  if (this->has_fixed_i2s_bitdepth() && this->i2s_bits_per_sample() != audio_stream_info.get_bits_per_sample() &&
-      this->i2s_bits_per_sample() != 2 * audio_stream_info.get_bits_per_sample()) {
-    ESP_LOGE(TAG, "Stream bits per sample must be <= speaker configuration");
-    return ESP_ERR_NOT_SUPPORTED;
+  // The data word width is fixed while the channel runs, so it is negotiated here, before the channel is configured
+  this->data_bits_per_sample_ = this->negotiate_data_bits_(audio_stream_info);
+  if (this->data_bits_per_sample_ != 0) {
+    ESP_LOGD(TAG, "Carrying %u-bit data in %u-bit slots", this->data_bits_per_sample_, this->i2s_bits_per_sample());
   }
-
-  // Create or reset event queue before starting channel so ISR callback is safe
-  if (this->i2s_event_queue_ == nullptr) {
-    this->i2s_event_queue_ = xQueueCreate(I2S_EVENT_QUEUE_COUNT, sizeof(int64_t));
-  } else {
-    xQueueReset(this->i2s_event_queue_);
+  // Any 8/16/24/32-bit stream is converted to the data width inline, so bit-depth-only mismatches need no resampler
+  if (!this->configure_output_kernel_()) {
+    ESP_LOGE(TAG, "Unsupported bits per sample: stream %u, slot %u", audio_stream_info.get_bits_per_sample(),
+             this->i2s_data_bits_per_sample());
+    return ESP_ERR_NOT_SUPPORTED;
   }
 
   // Start with no on_sent callback; the task registers it after the first preload
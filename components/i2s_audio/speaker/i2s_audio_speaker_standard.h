@@ -27,6 +27,49 @@ class I2SAudioSpeaker : public I2SAudioSpeakerBase {
   void run_speaker_task() override;
   esp_err_t start_i2s_driver(audio::AudioStreamInfo &audio_stream_info) override;
 
+  /// @brief Frames written into one DMA descriptor.
+  struct DmaSlot {
+    void *dma_buf{nullptr};
+    uint32_t frames{0};
+    uint32_t padding_frames{0};  // leading silence queued for a play_at() schedule, included in frames
+    uint32_t tail_frames{0};     // DSP tail flushed behind the stream's last frame, included in frames
+  };
+
+  /// @brief Speaker task loop for direct DMA writes. Waits for the ISR to report a sent descriptor, reports the frames
+  /// it held as played, and refills it in place from the ring buffer.
+  /// @return False if the task must exit instead of standing by
+  bool run_direct_dma_loop_(std::shared_ptr<audio_ring::AudioRing> &audio_ring_buffer,
+                            uint32_t ring_buffer_duration_ms);
+
+  /// @brief Parks the task in warm standby once playback stops: the channel is disabled but stays allocated along with
+  /// the task and its buffers, and the task sleeps until loop() wakes it for the next stream.
+  /// @return True once woken; false straight away if warm standby is disabled
+  bool park_in_standby_(audio_ring::AudioRing *audio_ring_buffer);
+
+  /// @brief Switches the running task to ``audio_stream_info_`` at a stream boundary, once all audio in the old format
+  /// has been converted. Only the sample format may change; the I2S clock and slots stay as they are. The ring buffer
+  /// is kept if it is large enough for the new format and replaced otherwise.
+  /// @return False if the new stream needs the task and channel restarted
+  bool reconfigure_stream_(std::shared_ptr<audio_ring::AudioRing> &audio_ring_buffer,
+                           uint32_t ring_buffer_duration_ms);
+
+  /// @brief Reports the frames a sent descriptor carried through the audio output callback and marks it free.
+  /// @param sent_timestamp esp_timer time at which the descriptor finished sending
+  /// @return Number of frames the descriptor held, including any padding
+  uint32_t complete_dma_slot_(DmaSlot &slot, int64_t sent_timestamp, uint32_t frames_per_dma_buffer);
+
+  /// @brief Reads stream audio from the ring buffer and converts it directly into a free DMA descriptor, padding or
+  /// trimming for a pending play_at() schedule. Any frames not filled stay as the silence the driver cleared the
+  /// descriptor to. Sets ``slot.frames`` and ``slot.padding_frames``.
+  /// @param buffer_start_us esp_timer time at which the descriptor's first frame will be heard
+  void fill_dma_buffer_(DmaSlot &slot, audio_ring::AudioRing *audio_ring_buffer, uint32_t frames_per_dma_buffer,
+                        int64_t buffer_start_us);
+
+  /// @brief Appends up to `tail_frames` frames of the DSP tail behind the audio in a refilled descriptor, as far as it
+  /// has room.
+  /// @return Number of tail frames written
+  uint32_t flush_dsp_tail_(DmaSlot &slot, uint32_t tail_frames, uint32_t frames_per_dma_buffer);
+
   I2SCommFmt i2s_comm_fmt_{I2SCommFmt::STANDARD};
 };
 
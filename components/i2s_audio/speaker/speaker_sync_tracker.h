@@ -0,0 +1,133 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include <cstdint>
+
+namespace esphome::i2s_audio {
+
+/// @brief Drift tracker behind the speaker's sync mode. It compares the stream frames the DMA has played against a
+/// reference clock and asks for one frame to be repeated or skipped whenever the smoothed difference leaves the
+/// deadband. Plain arithmetic on timestamps the caller supplies, so it carries no ESP-IDF dependency.
+class SyncTracker {
+ public:
+  /// @brief The stream is kept within this much of the reference timeline before a frame is inserted or dropped.
+  static constexpr int32_t DEADBAND_US = 250;
+  /// @brief Errors larger than this come from the reference clock being stepped (e.g., a first or corrected SNTP
+  /// sync) rather than drift; the tracker re-anchors instead of slewing through them one frame at a time.
+  static constexpr int32_t REANCHOR_US = 100000;
+  /// @brief The per-buffer error is smoothed over roughly this many DMA buffers to reject ISR and task scheduling
+  /// jitter.
+  static constexpr int32_t ERROR_SMOOTHING = 16;
+  /// @brief Buffers averaged after anchoring before any correction, so the jitter of the one timestamp the anchor was
+  /// taken from does not become a fixed offset of the whole timeline.
+  static constexpr int32_t SETTLE_BUFFERS = 32;
+
+  /// @brief Starts tracking a stream; the next full DMA buffer becomes the reference point.
+  /// @param channels Mono streams are corrected a sample pair at a time so the ESP32 mono swap stays aligned
+  void start(uint32_t sample_rate, uint8_t channels) {
+    this->sample_rate_ = sample_rate;
+    this->correction_frames_ = (channels == 1) ? 2 : 1;
+    this->reset();
+  }
+
+  /// @brief Drops the reference point, e.g. after an underflow or while the reference clock is not set.
+  void reset() {
+    this->anchored_ = false;
+    this->frames_presented_ = 0;
+    this->frames_corrected_ = 0;
+    this->error_us_ = 0;
+    this->pending_frames_ = 0;
+  }
+
+  /// @brief Feeds one DMA completion into the tracker.
+  /// @param presented_at_us Reference clock time at which the descriptor finished sending
+  /// @param frames_sent Stream frames the descriptor carried; fewer than `frames_per_dma_buffer` means an underflow
+  /// @param frames_per_dma_buffer Frames in a full descriptor
+  void update(int64_t presented_at_us, uint32_t frames_sent, uint32_t frames_per_dma_buffer) {
+    if (frames_sent < frames_per_dma_buffer) {
+      // Underflow silence is not part of the stream timeline
+      this->reset();
+      return;
+    }
+
+    if (!this->anchored_) {
+      this->anchor_(presented_at_us, 0);
+      return;
+    }
+
+    this->frames_presented_ += frames_sent;
+
+    // Positive when the stream plays ahead of the reference timeline (local clock fast), negative when it lags
+    const int64_t stream_us =
+        (this->frames_presented_ - this->frames_corrected_) * 1000000 / static_cast<int64_t>(this->sample_rate_);
+    const int64_t error_us = stream_us - (presented_at_us - this->anchor_us_);
+
+    if ((error_us > REANCHOR_US) || (error_us < -REANCHOR_US)) {
+      // A step of the reference clock says nothing about drift, so the lead tracked so far carries over
+      this->anchor_(presented_at_us, this->error_us_);
+      return;
+    }
+
+    if (this->settling_buffers_ > 0) {
+      this->settling_error_us_ += error_us;
+      if (--this->settling_buffers_ == 0) {
+        // Move the anchor so the averaged error matches the lead the timeline started with
+        this->anchor_us_ -= this->settling_error_us_ / SETTLE_BUFFERS - this->error_us_;
+      }
+      return;
+    }
+
+    this->error_us_ += (static_cast<int32_t>(error_us) - this->error_us_) / ERROR_SMOOTHING;
+
+    if (this->pending_frames_ == 0) {
+      if (this->error_us_ > DEADBAND_US) {
+        this->pending_frames_ = this->correction_frames_;  // repeat frames so the reference catches up
+      } else if (this->error_us_ < -DEADBAND_US) {
+        this->pending_frames_ = -this->correction_frames_;  // skip frames to catch up with the reference
+      }
+    }
+  }
+
+  /// @brief Correction wanted: positive to repeat that many frames, negative to skip them, 0 when in sync.
+  int32_t pending_frames() const { return this->pending_frames_; }
+
+  /// @brief Records that the pending frames were inserted or dropped.
+  void correction_applied() {
+    const int32_t frames = this->pending_frames_;
+    this->frames_corrected_ += frames;
+    // Credit the correction to the smoothed error right away so the filter lag does not trigger a second one
+    this->error_us_ -=
+        static_cast<int32_t>(static_cast<int64_t>(frames) * 1000000 / static_cast<int64_t>(this->sample_rate_));
+    this->pending_frames_ = 0;
+  }
+
+  /// @brief Smoothed lead of the stream over the reference timeline.
+  int32_t get_error_us() const { return this->error_us_; }
+
+ protected:
+  /// @brief Starts a new timeline at `presented_at_us` on which the stream leads the reference by `error_us`.
+  void anchor_(int64_t presented_at_us, int32_t error_us) {
+    this->reset();
+    this->anchor_us_ = presented_at_us + error_us;
+    this->error_us_ = error_us;
+    this->settling_buffers_ = SETTLE_BUFFERS;
+    this->settling_error_us_ = 0;
+    this->anchored_ = true;
+  }
+
+  int64_t anchor_us_{0};          // reference clock time at which the stream timeline starts
+  int64_t frames_presented_{0};   // DMA frames played since the anchor
+  int64_t frames_corrected_{0};   // net frames inserted (positive) or dropped (negative) since the anchor
+  int32_t error_us_{0};           // smoothed lead of the stream over the reference timeline
+  int32_t pending_frames_{0};
+  int64_t settling_error_us_{0};  // sum of the raw errors seen while settling
+  int32_t settling_buffers_{0};   // buffers left to average before the anchor is trusted
+  uint32_t sample_rate_{48000};
+  int32_t correction_frames_{1};
+  bool anchored_{false};
+};
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
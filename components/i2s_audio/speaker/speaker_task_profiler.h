@@ -0,0 +1,129 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include <freertos/FreeRTOS.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+#include <esp_cpu.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#endif
+
+namespace esphome::i2s_audio {
+
+/// @brief Timed sections of the speaker task. The direct DMA path reads and converts straight into the descriptors, so
+/// it reports both as PHASE_CONVERT and never PHASE_TRANSFER or PHASE_WRITE.
+enum SpeakerTaskPhase : uint8_t {
+  PHASE_DRAIN,     // reading DMA completions and firing the audio output callbacks
+  PHASE_TRANSFER,  // waiting for audio to arrive in the ring buffer
+  PHASE_CONVERT,   // the fused output pass
+  PHASE_WRITE,     // handing audio to the driver, including time blocked in i2s_channel_write
+  PHASE_COUNT,
+};
+
+/// @brief Fixed-bucket histogram of durations in microseconds. Bucket `i` counts values of `i` significant bits, so
+/// bucket 0 holds 0 us, bucket 1 holds 1 us, bucket 2 holds 2-3 us and so on; the last bucket is open-ended.
+struct TimingHistogram {
+  static constexpr size_t BUCKETS = 20;  // up to half a second before the open-ended bucket
+
+  void add(uint32_t us) {
+    const size_t bucket = (us == 0) ? 0 : 32 - __builtin_clz(us);
+    ++this->counts[(bucket < BUCKETS) ? bucket : BUCKETS - 1];
+    ++this->samples;
+    this->total_us += us;
+    if (us > this->max_us) {
+      this->max_us = us;
+    }
+    if (us < this->min_us) {
+      this->min_us = us;
+    }
+  }
+
+  /// @brief Upper edge of the bucket holding the `percent` percentile, or 0 if there are no samples.
+  uint32_t percentile_us(uint32_t percent) const {
+    const uint64_t rank = (static_cast<uint64_t>(this->samples) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+      seen += this->counts[bucket];
+      if ((seen >= rank) && (seen > 0)) {
+        return std::min<uint32_t>((1u << bucket) - 1, this->max_us);
+      }
+    }
+    return this->max_us;
+  }
+
+  uint32_t counts[BUCKETS]{};
+  uint32_t samples{0};
+  uint32_t max_us{0};
+  uint32_t min_us{UINT32_MAX};
+  uint64_t total_us{0};
+};
+
+#ifdef USE_I2S_AUDIO_SPEAKER_PROFILING
+
+/// @brief Start of a timed section: the CPU cycle counter and the core it was read on. Cycle counters are not
+/// synchronized between cores, so a section that migrated is discarded.
+struct ProfileMark {
+  uint32_t cycles;
+  BaseType_t core;
+};
+
+/// @brief Per-phase timing histograms plus a histogram of the DMA deadline margin. Written by the speaker task only;
+/// loop() reads them for reporting and asks for a reset, which the task performs at its next section so the two never
+/// write concurrently.
+class SpeakerTaskProfiler {
+ public:
+  ProfileMark mark() const { return {esp_cpu_get_cycle_count(), xPortGetCoreID()}; }
+
+  void record(SpeakerTaskPhase phase, const ProfileMark &start) {
+    const ProfileMark end = this->mark();
+    if (end.core != start.core) {
+      return;
+    }
+    this->reset_if_requested_();
+    this->phases_[phase].add((end.cycles - start.cycles) / esp_rom_get_cpu_ticks_per_us());
+  }
+
+  /// @brief Records how far ahead of playback audio was handed to the DMA; 0 means the deadline was missed.
+  void record_margin(int64_t margin_us) {
+    this->reset_if_requested_();
+    this->margin_.add((margin_us > 0) ? static_cast<uint32_t>(margin_us) : 0);
+  }
+
+  const TimingHistogram &get_phase(SpeakerTaskPhase phase) const { return this->phases_[phase]; }
+  const TimingHistogram &get_margin() const { return this->margin_; }
+
+  /// @brief Clears every histogram before the task's next measurement. Safe to call from any task.
+  void request_reset() { this->reset_requested_.store(true, std::memory_order_release); }
+
+ protected:
+  void reset_if_requested_() {
+    if (this->reset_requested_.exchange(false, std::memory_order_acquire)) {
+      for (TimingHistogram &histogram : this->phases_) {
+        histogram = TimingHistogram();
+      }
+      this->margin_ = TimingHistogram();
+    }
+  }
+
+  TimingHistogram phases_[PHASE_COUNT];
+  TimingHistogram margin_;
+  std::atomic<bool> reset_requested_{false};
+};
+
+#else
+
+// Profiling compiled out: marks carry nothing and the speaker's profiling hooks are empty inline functions
+struct ProfileMark {};
+
+#endif  // USE_I2S_AUDIO_SPEAKER_PROFILING
+
+}  // namespace esphome::i2s_audio
+
+#endif  // USE_ESP32
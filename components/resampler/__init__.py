@@ -1,2 +1,3 @@
-# Resampler component - provides microphone resampling
-# The actual implementation is in the microphone subdirectory
+# Resampler component - provides microphone and speaker resampling
+# The platforms are in the microphone and speaker subdirectories; both share the integer ratio resampler and the
+# input staging here
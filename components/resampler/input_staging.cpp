@@ -0,0 +1,29 @@
+#include "input_staging.h"
+
+#ifdef USE_ESP32
+
+#include <algorithm>
+
+namespace esphome::resampler {
+
+void stage_input(audio_ring::AudioRing &ring, ring_buffer::RingBuffer &staging, size_t block_frames,
+                 TickType_t partial_ticks, TickType_t empty_ticks) {
+  if (staging.available() == 0) {
+    ring.wait_for_block(block_frames, partial_ticks, empty_ticks);
+  }
+  size_t run_frames = 0;
+  const uint8_t *run = ring.acquire_read(run_frames);
+  while (run_frames > 0) {
+    const size_t frames = std::min(run_frames, staging.free() / ring.get_frame_bytes());
+    if (frames == 0) {
+      break;
+    }
+    staging.write(run, frames * ring.get_frame_bytes());
+    ring.commit_read(frames);
+    run = ring.acquire_read(run_frames);
+  }
+}
+
+}  // namespace esphome::resampler
+
+#endif
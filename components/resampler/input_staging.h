@@ -0,0 +1,25 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "esphome/components/audio_ring/audio_ring.h"
+#include "esphome/components/ring_buffer/ring_buffer.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <cstddef>
+
+namespace esphome::resampler {
+
+/// @brief Moves as much of `ring`'s audio as fits into `staging`, the ring buffer an audio::AudioResampler reads from.
+/// Shared by the speaker and microphone tasks. Only when nothing is staged does it wait, for a whole block of
+/// `block_frames` frames, so an idle task sleeps until audio or a command arrives.
+/// @param partial_ticks Longest wait for the rest of a block once its first frames are there
+/// @param empty_ticks Longest wait while `ring` is empty. portMAX_DELAY only once the resampler has nothing buffered
+///                    either, or the end of a stream stays in its transfer buffers until the next one arrives.
+void stage_input(audio_ring::AudioRing &ring, ring_buffer::RingBuffer &staging, size_t block_frames,
+                 TickType_t partial_ticks, TickType_t empty_ticks);
+
+}  // namespace esphome::resampler
+
+#endif
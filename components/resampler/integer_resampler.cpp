@@ -0,0 +1,289 @@
+#include "integer_resampler.h"
+
+#ifdef USE_ESP32
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome::resampler {
+
+// Passband edge as a fraction of the lower rate's Nyquist frequency; the rest of the band is left for the transition
+static constexpr float CUTOFF = 0.9f;
+// Kaiser window shape; about 70 dB of stopband attenuation
+static constexpr float KAISER_BETA = 7.0f;
+
+static constexpr float PI = 3.14159265358979f;
+
+/// @brief Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+static float bessel_i0(float x) {
+  const float quarter_x_squared = x * x / 4.0f;
+  float term = 1.0f;
+  float sum = 1.0f;
+  for (int k = 1; k < 32; ++k) {
+    term *= quarter_x_squared / static_cast<float>(k * k);
+    sum += term;
+    if (term < sum * 1e-8f) {
+      break;
+    }
+  }
+  return sum;
+}
+
+/// @brief Dot product of a history window and a filter. Four independent accumulators break the dependency chain so
+/// consecutive multiply-adds issue back to back instead of each waiting on the last.
+template<size_t Taps> static inline float dot(const float *x, const float *h) {
+  static_assert(Taps % 4 == 0, "Tap count must be a multiple of the unroll factor");
+  float acc0 = 0.0f;
+  float acc1 = 0.0f;
+  float acc2 = 0.0f;
+  float acc3 = 0.0f;
+  for (size_t i = 0; i < Taps; i += 4) {
+    acc0 += x[i] * h[i];
+    acc1 += x[i + 1] * h[i + 1];
+    acc2 += x[i + 2] * h[i + 2];
+    acc3 += x[i + 3] * h[i + 3];
+  }
+  return (acc0 + acc1) + (acc2 + acc3);
+}
+
+static inline int32_t to_q31(float sample) {
+  sample *= 2147483648.0f;
+  if (sample >= 2147483520.0f) {  // largest float below 2^31
+    return INT32_MAX;
+  }
+  if (sample <= -2147483648.0f) {
+    return INT32_MIN;
+  }
+  return static_cast<int32_t>(sample);
+}
+
+static bool is_supported_sample_size(uint8_t bytes) { return (bytes >= 2) && (bytes <= 4); }
+
+bool IntegerResampler::supports(const audio::AudioStreamInfo &input, const audio::AudioStreamInfo &output) {
+  if ((input.get_channels() != output.get_channels()) || (input.get_channels() > MAX_CHANNELS) ||
+      !is_supported_sample_size(input.samples_to_bytes(1)) || !is_supported_sample_size(output.samples_to_bytes(1))) {
+    return false;
+  }
+  const uint32_t low = std::min(input.get_sample_rate(), output.get_sample_rate());
+  const uint32_t high = std::max(input.get_sample_rate(), output.get_sample_rate());
+  return (low > 0) && (low != high) && (high % low == 0) && (high / low <= MAX_FACTOR);
+}
+
+uint32_t IntegerResampler::latency_frames(const audio::AudioStreamInfo &input, const audio::AudioStreamInfo &output) {
+  // The filter is symmetric, so it delays by half its length at the higher rate
+  const uint32_t factor = std::max(input.get_sample_rate(), output.get_sample_rate()) /
+                          std::min(input.get_sample_rate(), output.get_sample_rate());
+  const uint32_t high_rate_frames = factor * TAPS_PER_PHASE / 2;
+  return (output.get_sample_rate() > input.get_sample_rate()) ? high_rate_frames : high_rate_frames / factor;
+}
+
+void IntegerResampler::start(const audio::AudioStreamInfo &input, const audio::AudioStreamInfo &output) {
+  this->interpolating_ = output.get_sample_rate() > input.get_sample_rate();
+  this->factor_ = this->interpolating_ ? output.get_sample_rate() / input.get_sample_rate()
+                                       : input.get_sample_rate() / output.get_sample_rate();
+  this->channels_ = input.get_channels();
+  this->input_bytes_ = input.samples_to_bytes(1);
+  this->output_bytes_ = output.samples_to_bytes(1);
+
+  // Kaiser-windowed sinc low-pass at the higher rate
+  const size_t length = this->factor_ * TAPS_PER_PHASE;
+  const float cutoff = CUTOFF * 0.5f / this->factor_;  // cycles per sample
+  const float center = (length - 1) / 2.0f;
+  const float window_scale = 1.0f / bessel_i0(KAISER_BETA);
+  float filter[MAX_FILTER_TAPS];
+  float sum = 0.0f;
+  for (size_t n = 0; n < length; ++n) {
+    const float t = n - center;
+    const float sinc = (t == 0.0f) ? 2.0f * cutoff : std::sin(2.0f * PI * cutoff * t) / (PI * t);
+    const float position = t / center;
+    const float window = bessel_i0(KAISER_BETA * std::sqrt(std::max(0.0f, 1.0f - position * position))) * window_scale;
+    filter[n] = sinc * window;
+    sum += filter[n];
+  }
+
+  if (this->interpolating_) {
+    // Zero stuffing divides the level by the factor, so each branch gets unity gain instead of the whole filter
+    const float gain = this->factor_ / sum;
+    for (size_t phase = 0; phase < this->factor_; ++phase) {
+      for (size_t tap = 0; tap < TAPS_PER_PHASE; ++tap) {
+        this->coefficients_[phase * TAPS_PER_PHASE + tap] =
+            filter[(TAPS_PER_PHASE - 1 - tap) * this->factor_ + phase] * gain;
+      }
+    }
+    this->kernel_ = (this->factor_ == 2) ? &IntegerResampler::interpolate_<2> : &IntegerResampler::interpolate_<3>;
+  } else {
+    for (size_t tap = 0; tap < length; ++tap) {
+      this->coefficients_[tap] = filter[length - 1 - tap] / sum;
+    }
+    this->kernel_ = (this->factor_ == 2) ? &IntegerResampler::decimate_<2> : &IntegerResampler::decimate_<3>;
+  }
+
+  std::fill(&this->history_[0][0], &this->history_[0][0] + MAX_CHANNELS * 2 * MAX_FILTER_TAPS, 0.0f);
+  this->history_position_ = 0;
+  this->tail_frames_ = 0;
+  this->decimation_phase_ = 0;
+}
+
+size_t IntegerResampler::frames_for_room_(size_t frames, size_t room) const {
+  frames = std::min(frames, BLOCK_FRAMES);
+  if (this->interpolating_) {
+    return std::min(frames, room / this->factor_);
+  }
+  // Every input frame up to the one completing the output frame after the last that fits
+  return std::min(frames, (room + 1) * this->factor_ - 1 - this->decimation_phase_);
+}
+
+void IntegerResampler::process(const uint8_t *input, size_t &input_frames, uint8_t *output, size_t &output_frames) {
+  const size_t input_frame_bytes = this->input_bytes_ * this->channels_;
+  const size_t output_frame_bytes = this->output_bytes_ * this->channels_;
+  size_t consumed = 0;
+  size_t produced = 0;
+
+  while (consumed < input_frames) {
+    const size_t frames = this->frames_for_room_(input_frames - consumed, output_frames - produced);
+    if (frames == 0) {
+      break;
+    }
+
+    this->load_(input + consumed * input_frame_bytes, frames);
+    const size_t block_output_frames = (this->*kernel_)(frames);
+    this->store_(output + produced * output_frame_bytes, block_output_frames);
+
+    consumed += frames;
+    produced += block_output_frames;
+  }
+
+  if (consumed > 0) {
+    // The newest input reaches the centre of the symmetric filter after half its length at the input rate
+    this->tail_frames_ = this->interpolating_ ? TAPS_PER_PHASE / 2 : this->factor_ * TAPS_PER_PHASE / 2;
+  }
+  input_frames = consumed;
+  output_frames = produced;
+}
+
+void IntegerResampler::flush(uint8_t *output, size_t &output_frames) {
+  const size_t output_frame_bytes = this->output_bytes_ * this->channels_;
+  size_t produced = 0;
+
+  while (this->tail_frames_ > 0) {
+    const size_t frames = this->frames_for_room_(this->tail_frames_, output_frames - produced);
+    if (frames == 0) {
+      break;
+    }
+
+    std::fill_n(this->in_block_, frames * this->channels_, 0.0f);
+    const size_t block_output_frames = (this->*kernel_)(frames);
+    this->store_(output + produced * output_frame_bytes, block_output_frames);
+
+    this->tail_frames_ -= frames;
+    produced += block_output_frames;
+  }
+
+  output_frames = produced;
+}
+
+template<uint8_t Factor> size_t IntegerResampler::interpolate_(size_t frames) {
+  const uint8_t channels = this->channels_;
+  const float *in = this->in_block_;
+  float *out = this->out_block_;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    for (uint8_t channel = 0; channel < channels; ++channel) {
+      this->push_(channel, *in++, TAPS_PER_PHASE);
+    }
+    this->advance_(TAPS_PER_PHASE);
+
+    for (uint8_t phase = 0; phase < Factor; ++phase) {
+      const float *branch = this->coefficients_ + phase * TAPS_PER_PHASE;
+      for (uint8_t channel = 0; channel < channels; ++channel) {
+        *out++ = dot<TAPS_PER_PHASE>(this->history_[channel] + this->history_position_, branch);
+      }
+    }
+  }
+  return frames * Factor;
+}
+
+template<uint8_t Factor> size_t IntegerResampler::decimate_(size_t frames) {
+  static constexpr size_t LENGTH = Factor * TAPS_PER_PHASE;
+  const uint8_t channels = this->channels_;
+  const float *in = this->in_block_;
+  float *out = this->out_block_;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    for (uint8_t channel = 0; channel < channels; ++channel) {
+      this->push_(channel, *in++, LENGTH);
+    }
+    this->advance_(LENGTH);
+
+    // Only every Factor-th output of the full-rate filter is kept, so the others are never computed
+    if (++this->decimation_phase_ == Factor) {
+      this->decimation_phase_ = 0;
+      for (uint8_t channel = 0; channel < channels; ++channel) {
+        *out++ = dot<LENGTH>(this->history_[channel] + this->history_position_, this->coefficients_);
+      }
+    }
+  }
+  return (out - this->out_block_) / channels;
+}
+
+void IntegerResampler::load_(const uint8_t *input, size_t frames) {
+  const size_t samples = frames * this->channels_;
+  float *out = this->in_block_;
+  switch (this->input_bytes_) {
+    case 2: {
+      const int16_t *in = reinterpret_cast<const int16_t *>(input);
+      for (size_t i = 0; i < samples; ++i) {
+        out[i] = in[i] * (1.0f / 32768.0f);
+      }
+      break;
+    }
+    case 3: {
+      for (size_t i = 0; i < samples; ++i) {
+        const int32_t sample = static_cast<int32_t>((static_cast<uint32_t>(input[3 * i]) << 8) |
+                                                    (static_cast<uint32_t>(input[3 * i + 1]) << 16) |
+                                                    (static_cast<uint32_t>(input[3 * i + 2]) << 24));
+        out[i] = sample * (1.0f / 2147483648.0f);
+      }
+      break;
+    }
+    default: {
+      const int32_t *in = reinterpret_cast<const int32_t *>(input);
+      for (size_t i = 0; i < samples; ++i) {
+        out[i] = in[i] * (1.0f / 2147483648.0f);
+      }
+      break;
+    }
+  }
+}
+
+void IntegerResampler::store_(uint8_t *output, size_t frames) const {
+  const size_t samples = frames * this->channels_;
+  const float *in = this->out_block_;
+  switch (this->output_bytes_) {
+    case 2: {
+      int16_t *out = reinterpret_cast<int16_t *>(output);
+      for (size_t i = 0; i < samples; ++i) {
+        out[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(in[i] * 32768.0f, 32767.0f)));
+      }
+      break;
+    }
+    case 3: {
+      for (size_t i = 0; i < samples; ++i) {
+        const uint32_t sample = static_cast<uint32_t>(to_q31(in[i]));
+        output[3 * i] = static_cast<uint8_t>(sample >> 8);
+        output[3 * i + 1] = static_cast<uint8_t>(sample >> 16);
+        output[3 * i + 2] = static_cast<uint8_t>(sample >> 24);
+      }
+      break;
+    }
+    default: {
+      int32_t *out = reinterpret_cast<int32_t *>(output);
+      for (size_t i = 0; i < samples; ++i) {
+        out[i] = to_q31(in[i]);
+      }
+      break;
+    }
+  }
+}
+
+}  // namespace esphome::resampler
+
+#endif
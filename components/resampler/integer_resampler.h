@@ -0,0 +1,103 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "esphome/components/audio/audio.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome::resampler {
+
+/// @brief Polyphase FIR resampler for sample rates related by a small integer factor, e.g. 16 kHz <-> 48 kHz. It stands
+/// in for the general audio::AudioResampler on those ratios: the filter length is fixed at compile time, and each
+/// output sample is a single dot product over a contiguous window of history, so the inner loop has no phase
+/// arithmetic, no interpolation between filter tables, and no per-sample branches.
+///
+/// Samples may be 16, 24, or 32 bits on either side; they are converted to float once per block and channels are
+/// filtered independently. Large enough that it should be heap allocated.
+class IntegerResampler {
+ public:
+  /// @brief Taps in each polyphase branch. The full low-pass filter is `factor` times as long.
+  static constexpr size_t TAPS_PER_PHASE = 32;
+  static constexpr uint8_t MAX_FACTOR = 3;
+  static constexpr uint8_t MAX_CHANNELS = 4;
+  /// @brief Input frames converted to float and filtered per pass.
+  static constexpr size_t BLOCK_FRAMES = 32;
+
+  /// @brief True if the conversion is an interpolation or decimation by 2 or 3 with matching channel counts and
+  /// supported sample sizes.
+  static bool supports(const audio::AudioStreamInfo &input, const audio::AudioStreamInfo &output);
+
+  /// @brief Delay the filter adds, in frames at the output rate.
+  static uint32_t latency_frames(const audio::AudioStreamInfo &input, const audio::AudioStreamInfo &output);
+
+  /// @brief Designs the filter and clears the history for a conversion supports() accepts.
+  void start(const audio::AudioStreamInfo &input, const audio::AudioStreamInfo &output);
+
+  /// @brief Resamples as many whole input frames as the output has room for.
+  /// @param input_frames In: frames at `input`. Out: frames consumed
+  /// @param output_frames In: room at `output` in frames. Out: frames written
+  void process(const uint8_t *input, size_t &input_frames, uint8_t *output, size_t &output_frames);
+
+  /// @brief At the end of a stream, feeds silence through the filter to push out the input frames still in its
+  /// history. Call again while has_tail() is true if the output had too little room.
+  /// @param output_frames In: room at `output` in frames. Out: frames written
+  void flush(uint8_t *output, size_t &output_frames);
+
+  /// @brief True while input frames passed to process() have not fully left the filter.
+  bool has_tail() const { return this->tail_frames_ > 0; }
+
+  uint8_t get_factor() const { return this->factor_; }
+  bool is_interpolating() const { return this->interpolating_; }
+
+ protected:
+  static constexpr size_t MAX_FILTER_TAPS = MAX_FACTOR * TAPS_PER_PHASE;
+
+  /// @brief Filters `frames` input frames from `in_block_` into `out_block_`.
+  /// @return Output frames produced
+  using Kernel = size_t (IntegerResampler::*)(size_t frames);
+
+  template<uint8_t Factor> size_t interpolate_(size_t frames);
+  template<uint8_t Factor> size_t decimate_(size_t frames);
+
+  /// @brief Appends one sample to a channel's history. Each sample is stored twice, `length` apart, so the newest
+  /// `length` samples are always contiguous starting at `history_position_` once the frame is complete.
+  void push_(uint8_t channel, float sample, size_t length) {
+    float *history = this->history_[channel];
+    history[this->history_position_] = sample;
+    history[this->history_position_ + length] = sample;
+  }
+  void advance_(size_t length) {
+    this->history_position_ = (this->history_position_ + 1 == length) ? 0 : this->history_position_ + 1;
+  }
+
+  /// @brief Limits `frames` input frames to those whose output fits in `room` output frames.
+  size_t frames_for_room_(size_t frames, size_t room) const;
+
+  void load_(const uint8_t *input, size_t frames);
+  void store_(uint8_t *output, size_t frames) const;
+
+  Kernel kernel_{nullptr};
+
+  // Interpolation: branch p of the filter in coefficients_[p * TAPS_PER_PHASE...], scaled by the factor to keep unity
+  // gain. Decimation: the whole filter. Both are ordered to match the oldest-first history window.
+  float coefficients_[MAX_FILTER_TAPS];
+  float history_[MAX_CHANNELS][2 * MAX_FILTER_TAPS];
+  float in_block_[BLOCK_FRAMES * MAX_CHANNELS];
+  float out_block_[BLOCK_FRAMES * MAX_FACTOR * MAX_CHANNELS];
+
+  size_t history_position_{0};
+  size_t tail_frames_{0};        // silent input frames still needed to push the last input out of the history
+  uint8_t decimation_phase_{0};  // input frames since the last decimated output frame
+
+  uint8_t factor_{1};
+  uint8_t channels_{1};
+  uint8_t input_bytes_{2};
+  uint8_t output_bytes_{2};
+  bool interpolating_{false};
+};
+
+}  // namespace esphome::resampler
+
+#endif
@@ -1,5 +1,5 @@
 import esphome.codegen as cg
-from esphome.components import audio, esp32, microphone
+from esphome.components import audio, esp32, microphone, sensor
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_BUFFER_DURATION,
@@ -9,10 +9,13 @@ from esphome.const import (
     CONF_MICROPHONE,
     CONF_SAMPLE_RATE,
     CONF_TASK_STACK_IN_PSRAM,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     PLATFORM_ESP32,
+    STATE_CLASS_TOTAL_INCREASING,
 )
+from esphome.core import CORE, ID, Lambda
 
-AUTO_LOAD = ["audio"]
+AUTO_LOAD = ["audio", "audio_ring", "sensor"]
 CODEOWNERS = ["@kahrendt"]
 
 resampler_ns = cg.esphome_ns.namespace("resampler")
@@ -20,7 +23,20 @@ ResamplerMicrophone = resampler_ns.class_(
     "ResamplerMicrophone", cg.Component, microphone.Microphone
 )
 
+OverflowPolicy = resampler_ns.enum("OverflowPolicy", is_class=True)
+OVERFLOW_POLICIES = {
+    "drop_oldest": OverflowPolicy.DROP_OLDEST,
+    "drop_newest": OverflowPolicy.DROP_NEWEST,
+    "backpressure": OverflowPolicy.BACKPRESSURE,
+}
+
 CONF_TAPS = "taps"
+CONF_OVERFLOW_POLICY = "overflow_policy"
+CONF_DROPPED_FRAMES_SENSOR = "dropped_frames_sensor"
+CONF_USED_CHANNELS = "used_channels"
+
+USED_CHANNELS_ALL = "all"
+USED_CHANNELS_AUTO = "auto"
 
 
 def _set_stream_limits(config):
@@ -35,6 +51,76 @@ def _set_stream_limits(config):
     return config
 
 
+def _validate_used_channels(value):
+    if isinstance(value, str) and value.lower() in (
+        USED_CHANNELS_ALL,
+        USED_CHANNELS_AUTO,
+    ):
+        return value.lower()
+    return cv.All(cv.ensure_list(cv.int_range(min=0, max=7)), cv.Length(min=1))(
+        value
+    )
+
+
+def _validate_used_channels_in_stream(config):
+    used_channels = config[CONF_USED_CHANNELS]
+    if isinstance(used_channels, list):
+        channels = len(config[CONF_MICROPHONE][CONF_CHANNELS])
+        for channel in used_channels:
+            if channel >= channels:
+                raise cv.Invalid(
+                    f"Channel {channel} is not in the {channels} channel stream this "
+                    "microphone resamples",
+                    path=[CONF_USED_CHANNELS],
+                )
+    return config
+
+
+def _used_channels(mic_id):
+    """Channels of this microphone that the downstream microphone sources take, as a bitmask.
+
+    Every channel counts as used if a source reference is found without a channel list, if none is found at all, or if
+    the microphone is referenced anywhere else, e.g. from a lambda or a component that does not take a microphone
+    source, since those may read any channel.
+    """
+    used = 0
+    found = False
+    referenced_elsewhere = False
+
+    def visit(node):
+        nonlocal used, found, referenced_elsewhere
+        if isinstance(node, dict):
+            for key, value in node.items():
+                if (
+                    key == CONF_MICROPHONE
+                    and isinstance(value, dict)
+                    and value.get(CONF_MICROPHONE) == mic_id
+                ):
+                    found = True
+                    channels = value.get(CONF_CHANNELS)
+                    if channels is None:
+                        used = 0xFF
+                    else:
+                        for channel in channels:
+                            used |= 1 << channel
+                    # The source's own reference to this microphone is the one already accounted for
+                    visit({k: v for k, v in value.items() if k != CONF_MICROPHONE})
+                else:
+                    visit(value)
+        elif isinstance(node, list):
+            for value in node:
+                visit(value)
+        elif isinstance(node, ID):
+            if node == mic_id and not node.is_declaration:
+                referenced_elsewhere = True
+        elif isinstance(node, Lambda):
+            if any(required == mic_id for required in node.requires_ids):
+                referenced_elsewhere = True
+
+    visit(CORE.config)
+    return used if (found and not referenced_elsewhere) else 0xFF
+
+
 def _validate_taps(taps):
     value = cv.int_range(min=16, max=128)(taps)
     if value % 4 != 0:
@@ -59,10 +145,29 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_FILTERS, default=16): cv.int_range(min=2, max=1024),
             cv.Optional(CONF_SAMPLE_RATE, default=16000): cv.int_range(8000, 48000),
             cv.Optional(CONF_TAPS, default=16): _validate_taps,
+            # What happens to source audio when the resampler task falls behind. drop_oldest keeps the newest audio,
+            # drop_newest keeps what is queued. backpressure first stalls the source microphone's read task, and with
+            # it every other listener on that source, for at most 2 ms so a briefly late task can catch up; longer
+            # stalls would risk I2S DMA overruns, so whatever still does not fit is dropped as with drop_newest.
+            cv.Optional(CONF_OVERFLOW_POLICY, default="drop_oldest"): cv.enum(
+                OVERFLOW_POLICIES, lower=True
+            ),
+            # Channels past the highest used one are not resampled. "all" resamples every source channel, "auto"
+            # collects the channels the microphone sources reading from this microphone take, falling back to all of
+            # them if it is used any other way, and a list names the channels explicitly.
+            cv.Optional(
+                CONF_USED_CHANNELS, default=USED_CHANNELS_ALL
+            ): _validate_used_channels,
+            cv.Optional(CONF_DROPPED_FRAMES_SENSOR): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
         }
     ).extend(cv.COMPONENT_SCHEMA),
     cv.only_on([PLATFORM_ESP32]),
     _set_stream_limits,
+    _validate_used_channels_in_stream,
 )
 
 
@@ -101,3 +206,14 @@ async def to_code(config):
 
     cg.add(var.set_filters(config[CONF_FILTERS]))
     cg.add(var.set_taps(config[CONF_TAPS]))
+    cg.add(var.set_overflow_policy(config[CONF_OVERFLOW_POLICY]))
+    used_channels = config[CONF_USED_CHANNELS]
+    if used_channels == USED_CHANNELS_AUTO:
+        cg.add(var.set_used_channels(_used_channels(config[CONF_ID])))
+    elif used_channels != USED_CHANNELS_ALL:
+        mask = sum(1 << channel for channel in set(used_channels))
+        cg.add(var.set_used_channels(mask))
+
+    if conf := config.get(CONF_DROPPED_FRAMES_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_dropped_frames_sensor(sens))
@@ -3,7 +3,10 @@
 #ifdef USE_ESP32
 
 #include "esphome/components/audio/audio_resampler.h"
+#include "esphome/components/resampler/input_staging.h"
+#include "esphome/components/resampler/integer_resampler.h"
 
+#include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
@@ -15,10 +18,17 @@ namespace esphome::resampler {
 static const UBaseType_t RESAMPLER_TASK_PRIORITY = 1;
 static const UBaseType_t MAX_LISTENERS = 16;
 
+// Also the block of source audio the task waits for before it wakes to resample
 static const uint32_t TRANSFER_BUFFER_DURATION_MS = 16;
 
 static const uint32_t TASK_STACK_SIZE = 3072;
 
+// The source callback runs on the source microphone's read task, which other listeners share and which must be back
+// before its next DMA buffer completes; backpressure never holds it for longer than this
+static const uint32_t BACKPRESSURE_MAX_WAIT_MS = 2;
+
+static const uint32_t SENSOR_PUBLISH_INTERVAL_MS = 10000;
+
 static const char *const TAG = "resampler_microphone";
 
 enum ResamplingEventGroupBits : uint32_t {
@@ -50,19 +60,15 @@ void ResamplerMicrophone::setup() {
   }
 
   this->microphone_source_->add_data_callback([this](const std::vector<uint8_t> &data) {
-    if (this->state_ == microphone::STATE_STOPPED) {
+    if (!this->stream_ready_.load(std::memory_order_acquire)) {
       return;
     }
-    if (this->requires_resampling_()) {
-      std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = this->ring_buffer_.lock();
+    if (this->inline_resampling_) {
+      this->resample_inline_(this->narrow_channels_(data));
+    } else if (this->requires_resampling_()) {
+      std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
       if (this->ring_buffer_.use_count() > 1) {
-        size_t bytes_free = temp_ring_buffer->free();
-
-        if (bytes_free < data.size()) {
-          xEventGroupSetBits(this->event_group_, ResamplingEventGroupBits::WARNING_FULL_RING_BUFFER);
-          temp_ring_buffer->reset();
-        }
-        temp_ring_buffer->write((void *) data.data(), data.size());
+        this->write_to_ring_(*temp_ring_buffer, this->narrow_channels_(data));
       }
     } else if (this->data_callbacks_.size() > 0) {
       // No resampling required, just pass through the audio
@@ -103,13 +109,27 @@ void ResamplerMicrophone::loop() {
     xEventGroupClearBits(this->event_group_, ALL_BITS);
     this->status_clear_error();
 
+    this->stream_ready_.store(false, std::memory_order_relaxed);
     this->state_ = microphone::STATE_STOPPED;
   }
 
   if (event_group_bits & ResamplingEventGroupBits::WARNING_FULL_RING_BUFFER) {
     xEventGroupClearBits(this->event_group_, ResamplingEventGroupBits::WARNING_FULL_RING_BUFFER);
-    ESP_LOGW(TAG, "Ring buffer full, resetting it.");
+    ESP_LOGW(TAG, "Ring buffer full, dropping audio");
+  }
+
+#ifdef USE_SENSOR
+  const uint32_t now = millis();
+  if ((this->dropped_frames_sensor_ != nullptr) &&
+      (now - this->last_sensor_publish_ms_ >= SENSOR_PUBLISH_INTERVAL_MS)) {
+    this->last_sensor_publish_ms_ = now;
+    const uint32_t dropped_frames = this->dropped_frames_.load(std::memory_order_relaxed);
+    if (dropped_frames != this->published_dropped_frames_) {
+      this->published_dropped_frames_ = dropped_frames;
+      this->dropped_frames_sensor_->publish_state(dropped_frames);
+    }
   }
+#endif
 
   // Start the microphone if any semaphores are taken
   if ((uxSemaphoreGetCount(this->active_listeners_semaphore_) < MAX_LISTENERS) &&
@@ -125,23 +145,39 @@ void ResamplerMicrophone::loop() {
 
   switch (this->state_) {
     case microphone::STATE_STARTING:
-      if (this->status_has_error()) {
+      if (this->status_has_error() || (this->task_handle_ != nullptr)) {
+        // Retrying after a failed start, or the task is starting and reports TASK_RUNNING when it is
         break;
       }
 
+      // The callback has ignored audio since the last stop, so nothing reads the settings while they change here
       this->configure_stream_settings_();
 
-      if (this->requires_resampling_()) {
-        if (this->task_handle_ == nullptr) {
-          if (this->start_task_() != ESP_OK) {
-            ESP_LOGE(TAG, "Task failed to start, retrying in 1 second");
-            this->status_momentary_error("task_fail", 1000);
-          } else {
-            this->microphone_source_->start();
-          }
+      if (this->inline_resampling_) {
+        // Resampled in the source's data callback, so only the filter needs to be ready before the source starts
+        if (this->integer_resampler_ == nullptr) {
+          this->integer_resampler_ = make_unique<IntegerResampler>();
+          this->output_data_.reserve(this->audio_stream_info_.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS));
+        }
+        this->integer_resampler_->start(this->resampled_source_stream_info_(), this->audio_stream_info_);
+        ESP_LOGD(TAG, "Resampling inline");
+        this->stream_ready_.store(true, std::memory_order_release);
+        this->microphone_source_->start();
+        this->state_ = microphone::STATE_RUNNING;
+      } else if (this->requires_resampling_()) {
+        // Anything held back from the last run belongs to a ring that no longer exists
+        this->held_back_bytes_ = 0;
+        this->skip_frames_.store(0, std::memory_order_relaxed);
+        if (this->start_task_() != ESP_OK) {
+          ESP_LOGE(TAG, "Task failed to start, retrying in 1 second");
+          this->status_momentary_error("task_fail", 1000);
+        } else {
+          this->stream_ready_.store(true, std::memory_order_release);
+          this->microphone_source_->start();
         }
       } else {
         // No task needed, just start the source mic and update state
+        this->stream_ready_.store(true, std::memory_order_release);
         this->microphone_source_->start();
         this->state_ = microphone::STATE_RUNNING;
       }
@@ -151,10 +187,16 @@ void ResamplerMicrophone::loop() {
       break;
     case microphone::STATE_STOPPING:
       this->microphone_source_->stop();  // stop source mic
-      if (this->requires_resampling_()) {
+      if (this->requires_resampling_() && !this->inline_resampling_) {
         xEventGroupSetBits(this->event_group_, ResamplingEventGroupBits::COMMAND_STOP);
+        std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
+        if (temp_ring_buffer) {
+          // The task only wakes for audio, so nudge it to see the command
+          temp_ring_buffer->wake_consumer();
+        }
       } else {
         // No task needed, just update state directly
+        this->stream_ready_.store(false, std::memory_order_relaxed);
         this->state_ = microphone::STATE_STOPPED;
       }
       break;
@@ -220,14 +262,127 @@ void ResamplerMicrophone::deallocate_task_stack_() {
 }
 
 void ResamplerMicrophone::configure_stream_settings_() {
+  // Channels past the highest one used downstream are never resampled
+  uint8_t channels = this->microphone_source_->get_audio_stream_info().get_channels();
+  while ((channels > 1) && !(this->used_channels_ & (1 << (channels - 1)))) {
+    --channels;
+  }
+  this->resampled_channels_ = channels;
+
   if (this->requires_resampling_()) {
     // Resampler outputs 32 bits per sample and lets downstream MicrophoneSource handle conversions
-    this->audio_stream_info_ = audio::AudioStreamInfo(
-        32, this->microphone_source_->get_audio_stream_info().get_channels(), this->target_sample_rate_);
+    this->audio_stream_info_ = audio::AudioStreamInfo(32, channels, this->target_sample_rate_);
   } else {
     // No resampling needed, so just pass through the source mic's stream info
     this->audio_stream_info_ = this->microphone_source_->get_audio_stream_info();
   }
+  // Integer ratios are cheap enough to resample in the source's callback instead of handing the audio to a task
+  this->inline_resampling_ =
+      this->requires_resampling_() &&
+      IntegerResampler::supports(this->resampled_source_stream_info_(), this->audio_stream_info_);
+}
+
+audio::AudioStreamInfo ResamplerMicrophone::resampled_source_stream_info_() const {
+  const audio::AudioStreamInfo source_stream_info = this->microphone_source_->get_audio_stream_info();
+  return audio::AudioStreamInfo(source_stream_info.get_bits_per_sample(), this->resampled_channels_,
+                                source_stream_info.get_sample_rate());
+}
+
+const std::vector<uint8_t> &ResamplerMicrophone::narrow_channels_(const std::vector<uint8_t> &data) {
+  const audio::AudioStreamInfo source_stream_info = this->microphone_source_->get_audio_stream_info();
+  const uint8_t channels = this->resampled_channels_;
+  const uint8_t resampled_mask = (1 << channels) - 1;
+  if ((channels == source_stream_info.get_channels()) && ((this->used_channels_ & resampled_mask) == resampled_mask)) {
+    return data;
+  }
+
+  const size_t sample_bytes = source_stream_info.samples_to_bytes(1);
+  const size_t source_frame_bytes = source_stream_info.frames_to_bytes(1);
+  const size_t frames = data.size() / source_frame_bytes;
+  this->narrowed_data_.resize(frames * channels * sample_bytes);
+
+  const uint8_t *in = data.data();
+  uint8_t *out = this->narrowed_data_.data();
+  for (size_t frame = 0; frame < frames; ++frame) {
+    for (uint8_t channel = 0; channel < channels; ++channel) {
+      if (this->used_channels_ & (1 << channel)) {
+        std::memcpy(out, in + channel * sample_bytes, sample_bytes);
+      } else {
+        std::memset(out, 0, sample_bytes);
+      }
+      out += sample_bytes;
+    }
+    in += source_frame_bytes;
+  }
+  return this->narrowed_data_;
+}
+
+void ResamplerMicrophone::resample_inline_(const std::vector<uint8_t> &data) {
+  const size_t input_frame_bytes = this->resampled_source_stream_info_().frames_to_bytes(1);
+  const size_t output_chunk_frames = this->audio_stream_info_.ms_to_frames(TRANSFER_BUFFER_DURATION_MS);
+  const size_t total_frames = data.size() / input_frame_bytes;
+
+  size_t frames_done = 0;
+  while (frames_done < total_frames) {
+    size_t input_frames = total_frames - frames_done;
+    size_t output_frames = output_chunk_frames;
+    this->output_data_.resize(this->audio_stream_info_.frames_to_bytes(output_chunk_frames));
+    this->integer_resampler_->process(data.data() + frames_done * input_frame_bytes, input_frames,
+                                      this->output_data_.data(), output_frames);
+    frames_done += input_frames;
+
+    if (output_frames > 0) {
+      this->output_data_.resize(this->audio_stream_info_.frames_to_bytes(output_frames));
+      this->data_callbacks_.call(this->output_data_);
+    }
+  }
+}
+
+void ResamplerMicrophone::write_to_ring_(audio_ring::AudioRing &ring, const std::vector<uint8_t> &data) {
+  const size_t frame_bytes = ring.get_frame_bytes();
+  size_t dropped_bytes = 0;
+
+  switch (this->overflow_policy_) {
+    case OverflowPolicy::DROP_OLDEST: {
+      if (this->held_back_bytes_ > 0) {
+        // The held-back audio is older than this block, so it goes first. If the task still has not made room for it,
+        // this block replaces it and the skip request below is resized to match.
+        const size_t flushed = ring.write(this->held_back_data_.data(), this->held_back_bytes_, 0);
+        dropped_bytes += this->held_back_bytes_ - flushed;
+        this->held_back_bytes_ = 0;
+      }
+      const size_t written = ring.write(data.data(), data.size(), 0);
+      const size_t remaining = data.size() - written;
+      if (remaining >= frame_bytes) {
+        // Only the task may release audio from the ring, so ask it to skip the oldest frames and hold this back
+        // meanwhile
+        if (this->held_back_data_.size() < remaining) {
+          this->held_back_data_.resize(remaining);
+        }
+        std::memcpy(this->held_back_data_.data(), data.data() + written, remaining);
+        this->held_back_bytes_ = remaining;
+        this->skip_frames_.store(remaining / frame_bytes, std::memory_order_release);
+        xEventGroupSetBits(this->event_group_, ResamplingEventGroupBits::WARNING_FULL_RING_BUFFER);
+      }
+      break;
+    }
+    case OverflowPolicy::DROP_NEWEST:
+      dropped_bytes = data.size() - ring.write(data.data(), data.size(), 0);
+      break;
+    case OverflowPolicy::BACKPRESSURE: {
+      // Gives a task that is just running late a moment to make room. With a tick longer than the cap this rounds to
+      // no wait at all, and the policy behaves like DROP_NEWEST.
+      const uint32_t block_ms = this->resampled_source_stream_info_().bytes_to_ms(data.size());
+      const TickType_t wait_ticks = pdMS_TO_TICKS(std::min(block_ms, BACKPRESSURE_MAX_WAIT_MS));
+      dropped_bytes = data.size() - ring.write(data.data(), data.size(), wait_ticks);
+      break;
+    }
+  }
+
+  if (dropped_bytes >= frame_bytes) {
+    this->dropped_frames_.fetch_add(dropped_bytes / frame_bytes, std::memory_order_relaxed);
+    xEventGroupSetBits(this->event_group_, ResamplingEventGroupBits::WARNING_FULL_RING_BUFFER);
+  }
 }
 
 bool ResamplerMicrophone::requires_resampling_() const {
@@ -239,7 +394,7 @@ void ResamplerMicrophone::resample_task(void *params) {
 
   xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::TASK_STARTING);
 
-  audio::AudioStreamInfo source_stream_info = this_resampler->microphone_source_->get_audio_stream_info();
+  audio::AudioStreamInfo source_stream_info = this_resampler->resampled_source_stream_info_();
 
   std::unique_ptr<audio::AudioResampler> resampler =
       make_unique<audio::AudioResampler>(source_stream_info.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS),
@@ -248,16 +403,21 @@ void ResamplerMicrophone::resample_task(void *params) {
   esp_err_t err = resampler->start(source_stream_info, this_resampler->audio_stream_info_, this_resampler->taps_,
                                    this_resampler->filters_);
 
+  std::shared_ptr<audio_ring::AudioRing> input_ring_buffer;
+  std::shared_ptr<ring_buffer::RingBuffer> staging_ring_buffer;
   std::shared_ptr<ring_buffer::RingBuffer> output_ring_buffer;
   if (err == ESP_OK) {
-    std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer =
-        ring_buffer::RingBuffer::create(source_stream_info.ms_to_bytes(this_resampler->buffer_duration_ms_));
+    input_ring_buffer = audio_ring::AudioRing::create(
+        source_stream_info.ms_to_bytes(this_resampler->buffer_duration_ms_), source_stream_info.frames_to_bytes(1));
+    // The AudioResampler only reads from a ring_buffer::RingBuffer, so the task stages the source audio through one
+    staging_ring_buffer = ring_buffer::RingBuffer::create(source_stream_info.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS));
 
-    if (temp_ring_buffer.use_count() == 0) {
+    if ((input_ring_buffer.use_count() == 0) || (staging_ring_buffer.use_count() == 0)) {
       err = ESP_ERR_NO_MEM;
     } else {
-      this_resampler->ring_buffer_ = temp_ring_buffer;
-      resampler->add_source(this_resampler->ring_buffer_);
+      this_resampler->ring_buffer_ = input_ring_buffer;
+      std::weak_ptr<ring_buffer::RingBuffer> staging_ring_buffer_weak = staging_ring_buffer;
+      resampler->add_source(staging_ring_buffer_weak);
 
       // Create output ring buffer for resampled audio
       output_ring_buffer = ring_buffer::RingBuffer::create(
@@ -284,13 +444,34 @@ void ResamplerMicrophone::resample_task(void *params) {
   const size_t output_chunk_size = this_resampler->audio_stream_info_.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS);
   output_data.resize(output_chunk_size);
 
+  // Whether the AudioResampler and its staging ring are empty, so the task may sleep until more audio arrives
+  bool resampler_drained = true;
+
   while (err == ESP_OK) {
     if (xEventGroupGetBits(this_resampler->event_group_) & ResamplingEventGroupBits::COMMAND_STOP) {
       break;
     }
 
+    // Make room for audio the source callback is holding back under the drop-oldest policy
+    const uint32_t skip_frames = this_resampler->skip_frames_.exchange(0, std::memory_order_acquire);
+    if (skip_frames > 0) {
+      const size_t skipped_frames = std::min<size_t>(skip_frames, input_ring_buffer->available_frames());
+      input_ring_buffer->commit_read(skipped_frames);
+      this_resampler->dropped_frames_.fetch_add(skipped_frames, std::memory_order_relaxed);
+    }
+
+    // Resampled audio leaves the AudioResampler at the start of its next call, so while it holds any the task only
+    // waits a block's duration before calling it again; otherwise the last block before the source pauses would wait
+    // for the source to resume
+    stage_input(*input_ring_buffer, *staging_ring_buffer, source_stream_info.ms_to_frames(TRANSFER_BUFFER_DURATION_MS),
+                pdMS_TO_TICKS(TRANSFER_BUFFER_DURATION_MS),
+                resampler_drained ? portMAX_DELAY : pdMS_TO_TICKS(TRANSFER_BUFFER_DURATION_MS));
+
+    // With stop_gracefully set, resample() reports FINISHED instead of running when neither its transfer buffers nor
+    // the staging ring hold any audio; the task carries on and sleeps until the source delivers more
     int32_t ms_differential = 0;
-    audio::AudioResamplerState resampler_state = resampler->resample(false, &ms_differential);
+    audio::AudioResamplerState resampler_state = resampler->resample(true, &ms_differential);
+    resampler_drained = (resampler_state == audio::AudioResamplerState::FINISHED);
 
     // Read resampled audio from output ring buffer and send via callbacks
     if (output_ring_buffer != nullptr) {
@@ -309,9 +490,7 @@ void ResamplerMicrophone::resample_task(void *params) {
       }
     }
 
-    if (resampler_state == audio::AudioResamplerState::FINISHED) {
-      break;
-    } else if (resampler_state == audio::AudioResamplerState::FAILED) {
+    if (resampler_state == audio::AudioResamplerState::FAILED) {
       xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::ERR_ESP_FAIL);
       break;
     }
@@ -319,6 +498,10 @@ void ResamplerMicrophone::resample_task(void *params) {
 
   xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::TASK_STOPPING);
   resampler.reset();
+  // The task is deleted rather than returning, so its buffers are released here
+  input_ring_buffer.reset();
+  staging_ring_buffer.reset();
+  output_ring_buffer.reset();
   xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::TASK_STOPPED);
 
   while (true) {
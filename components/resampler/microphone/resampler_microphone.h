@@ -4,12 +4,19 @@
 
 #include "esphome/components/audio/audio.h"
 #include "esphome/components/audio/audio_transfer_buffer.h"
+#include "esphome/components/audio_ring/audio_ring.h"
 #include "esphome/components/microphone/microphone_source.h"
+#include "esphome/components/resampler/integer_resampler.h"
 #include "esphome/components/ring_buffer/ring_buffer.h"
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
 
 #include "esphome/core/component.h"
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
@@ -17,6 +24,19 @@
 
 namespace esphome::resampler {
 
+/// @brief What the source callback does with audio that does not fit into the task's ring. Whichever is chosen, a
+/// single overflow never loses more than the block that did not fit.
+///
+/// BACKPRESSURE trades a short stall of the source for fewer drops: the callback runs on the source microphone's
+/// read task, so every listener on that source and the next I2S read wait with it. The wait is capped at a couple of
+/// milliseconds, well below a DMA period, which covers a resampler task that is briefly late but not one that has
+/// stalled; audio still not fitting then is dropped as with DROP_NEWEST.
+enum class OverflowPolicy : uint8_t {
+  DROP_OLDEST,   // keep the new audio; the task skips as many of the oldest queued frames
+  DROP_NEWEST,   // keep the queued audio; the part of the block that did not fit is dropped
+  BACKPRESSURE,  // wait briefly for the task to make room, then drop what still does not fit
+};
+
 class ResamplerMicrophone : public Component, public microphone::Microphone {
  public:
   float get_setup_priority() const override { return esphome::setup_priority::DATA; }
@@ -37,6 +57,15 @@ class ResamplerMicrophone : public Component, public microphone::Microphone {
   void set_taps(uint16_t taps) { this->taps_ = taps; }
 
   void set_buffer_duration(uint32_t buffer_duration_ms) { this->buffer_duration_ms_ = buffer_duration_ms; }
+  void set_overflow_policy(OverflowPolicy overflow_policy) { this->overflow_policy_ = overflow_policy; }
+  /// @brief Bitmask of the channels downstream microphone sources take. Channels past the highest one set are dropped
+  /// before resampling, so the published stream is narrower and the filter does proportionally less work.
+  void set_used_channels(uint8_t used_channels) { this->used_channels_ = used_channels; }
+
+#ifdef USE_SENSOR
+  /// @brief Total source frames dropped because the task fell behind
+  SUB_SENSOR(dropped_frames)
+#endif
 
  protected:
   /// @brief Starts the resampler task after allocating the task stack
@@ -50,13 +79,31 @@ class ResamplerMicrophone : public Component, public microphone::Microphone {
   inline bool requires_resampling_() const;
   static void resample_task(void *params);
 
-  /// @brief Sets the Microphone ``audio_stream_info_`` member variable to the configured I2S settings.
+  /// @brief Sets the Microphone ``audio_stream_info_`` member variable to the configured I2S settings, and picks
+  /// inline resampling when the ratio allows it.
   void configure_stream_settings_();
 
+  /// @brief The source's stream narrowed to the channels that are resampled.
+  audio::AudioStreamInfo resampled_source_stream_info_() const;
+
+  /// @brief Returns `data` with only the resampled channels, silencing any unused ones below the highest used channel
+  /// so the downstream channel numbers still hold. Returns `data` itself when every channel is used.
+  const std::vector<uint8_t> &narrow_channels_(const std::vector<uint8_t> &data);
+
+  /// @brief Resamples a block from the source in its callback and passes the result on in chunks of up to
+  /// TRANSFER_BUFFER_DURATION_MS.
+  void resample_inline_(const std::vector<uint8_t> &data);
+
+  /// @brief Queues a block from the source for the task, handling a full ring according to the overflow policy.
+  void write_to_ring_(audio_ring::AudioRing &ring, const std::vector<uint8_t> &data);
+
   uint32_t target_sample_rate_;
   uint32_t buffer_duration_ms_;
   uint16_t taps_;
   uint16_t filters_;
+  OverflowPolicy overflow_policy_{OverflowPolicy::DROP_OLDEST};
+  uint8_t used_channels_{0xFF};
+  uint8_t resampled_channels_{1};  // source channels up to the highest used one
   bool task_stack_in_psram_{false};
 
   EventGroupHandle_t event_group_{nullptr};
@@ -68,7 +115,33 @@ class ResamplerMicrophone : public Component, public microphone::Microphone {
   StackType_t *task_stack_buffer_{nullptr};
   StaticTask_t task_stack_;
 
-  std::weak_ptr<ring_buffer::RingBuffer> ring_buffer_;
+  // Source audio from the data callback, handed lock-free to the task
+  std::weak_ptr<audio_ring::AudioRing> ring_buffer_;
+
+  // Drop-oldest: the part of the last block that did not fit, queued ahead of the next block once the task has skipped
+  // the frames requested in skip_frames_ to make room for it. Only the source callback touches the held-back block.
+  std::vector<uint8_t> held_back_data_;
+  size_t held_back_bytes_{0};
+  std::atomic<uint32_t> skip_frames_{0};
+
+  std::atomic<uint32_t> dropped_frames_{0};
+#ifdef USE_SENSOR
+  uint32_t published_dropped_frames_{UINT32_MAX};  // publishes the first count even if it is 0
+  uint32_t last_sensor_publish_ms_{0};
+#endif
+
+  // Inline mode: the filter and output block are only used from the source's callback once started, and kept
+  // allocated across restarts so a late callback never sees them freed
+  std::unique_ptr<IntegerResampler> integer_resampler_;
+  std::vector<uint8_t> output_data_;
+  bool inline_resampling_{false};
+
+  // Set by loop() once the stream settings and the inline filter are in place. The source may already be running for
+  // another listener, so its callback ignores audio until then instead of reading them mid-change.
+  std::atomic<bool> stream_ready_{false};
+
+  // Source blocks with the unused channels removed; only touched from the source's callback
+  std::vector<uint8_t> narrowed_data_;
 
   audio::AudioStreamInfo source_stream_info_;
 };
@@ -1,5 +1,6 @@
 import esphome.codegen as cg
 from esphome.components import audio, psram, speaker
+from esphome.components.timed_speaker import TimedSpeaker
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_BITS_PER_SAMPLE,
@@ -14,12 +15,12 @@ from esphome.const import (
 )
 from esphome.core.entity_helpers import inherit_property_from
 
-AUTO_LOAD = ["audio"]
+AUTO_LOAD = ["audio", "audio_ring", "timed_speaker"]
 CODEOWNERS = ["@kahrendt"]
 
 resampler_ns = cg.esphome_ns.namespace("resampler")
 ResamplerSpeaker = resampler_ns.class_(
-    "ResamplerSpeaker", cg.Component, speaker.Speaker
+    "ResamplerSpeaker", cg.Component, speaker.Speaker, TimedSpeaker
 )
 
 CONF_TAPS = "taps"
@@ -93,8 +94,12 @@ async def to_code(config):
     await cg.register_component(var, config)
     await speaker.register_speaker(var, config)
 
-    output_spkr = await cg.get_variable(config[CONF_OUTPUT_SPEAKER])
+    output_id, output_spkr = await cg.get_variable_with_full_id(
+        config[CONF_OUTPUT_SPEAKER]
+    )
     cg.add(var.set_output_speaker(output_spkr))
+    if output_id.type.inherits_from(TimedSpeaker):
+        cg.add(var.set_output_timed_speaker(output_spkr))
 
     cg.add(var.set_buffer_duration(config[CONF_BUFFER_DURATION]))
 
@@ -3,20 +3,29 @@
 #ifdef USE_ESP32
 
 #include "esphome/components/audio/audio_resampler.h"
+#include "esphome/components/resampler/input_staging.h"
+#include "esphome/components/resampler/integer_resampler.h"
 
 #include "esphome/core/application.h"
 #include "esphome/core/defines.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
+#include <esp_timer.h>
+
 #include <algorithm>
 #include <cstring>
+#include <vector>
 
 namespace esphome::resampler {
 
 static const UBaseType_t RESAMPLER_TASK_PRIORITY = 1;
 
 static const uint32_t TRANSFER_BUFFER_DURATION_MS = 50;
+// Audio play() queues before the task wakes to resample it. A shorter tail is resampled once it is this old.
+static const uint32_t INPUT_BLOCK_MS = 10;
+// Longest the task blocks on a full output speaker before checking for commands again
+static const uint32_t OUTPUT_WAIT_MS = 20;
 
 static const uint32_t TASK_STACK_SIZE = 3072;
 
@@ -64,15 +73,28 @@ void ResamplerSpeaker::setup() {
   }
 
   this->output_speaker_->add_audio_output_callback([this](uint32_t new_frames, int64_t write_timestamp) {
+    uint32_t frames = new_frames;
     if (this->audio_stream_info_.get_sample_rate() != this->target_stream_info_.get_sample_rate()) {
       // Convert the number of frames from the target sample rate to the source sample rate. Track the remainder to
       // avoid losing frames from integer division truncation.
       const uint64_t numerator = new_frames * this->audio_stream_info_.get_sample_rate() + this->callback_remainder_;
       const uint64_t denominator = this->target_stream_info_.get_sample_rate();
       this->callback_remainder_ = numerator % denominator;
-      this->audio_output_callback_(numerator / denominator, write_timestamp);
-    } else {
-      this->audio_output_callback_(new_frames, write_timestamp);
+      frames = numerator / denominator;
+    }
+
+    // Silence play_at() queued ahead of an early clip was never played by the caller, so it is not reported
+    const uint64_t position = this->frames_reported_.load(std::memory_order_relaxed);
+    const uint64_t padding_end = this->padding_end_frame_.load(std::memory_order_acquire);
+    const uint64_t padding_start = this->padding_start_frame_.load(std::memory_order_relaxed);
+    this->frames_reported_.store(position + frames, std::memory_order_release);
+    const uint64_t overlap_start = std::max(position, padding_start);
+    const uint64_t overlap_end = std::min(position + frames, padding_end);
+    if (overlap_end > overlap_start) {
+      frames -= overlap_end - overlap_start;
+    }
+    if (frames > 0) {
+      this->audio_output_callback_(frames, write_timestamp);
     }
   });
 
@@ -102,8 +124,19 @@ void ResamplerSpeaker::loop() {
     // Leave bits set if STATE_STOPPING - will be processed once stopped
   } else if (event_group_bits & ResamplingEventGroupBits::COMMAND_FINISH) {
     if (this->state_ == speaker::STATE_RUNNING) {
-      xEventGroupClearBits(this->event_group_, ResamplingEventGroupBits::COMMAND_FINISH);
-      this->output_speaker_->finish();
+      // The output speaker finishes as soon as its own buffer runs dry, so it is only told once the task has passed
+      // on everything play() queued
+      if (!this->has_resampler_buffered_data_()) {
+        xEventGroupClearBits(this->event_group_, ResamplingEventGroupBits::COMMAND_FINISH);
+        this->output_speaker_->finish();
+      } else {
+        // With the input ring empty, the task only has the integer resampler's filter tail left, which it flushes
+        // once woken
+        std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
+        if (temp_ring_buffer && (temp_ring_buffer->available() == 0)) {
+          temp_ring_buffer->wake_consumer();
+        }
+      }
     } else if (this->state_ == speaker::STATE_STOPPED) {
       // Already stopped, just clear the command bit
       xEventGroupClearBits(this->event_group_, ResamplingEventGroupBits::COMMAND_FINISH);
@@ -162,6 +195,11 @@ void ResamplerSpeaker::loop() {
   switch (this->state_) {
     case speaker::STATE_STARTING: {
       if (!this->waiting_for_output_) {
+        // Nothing is queued or playing yet, so the play_at() padding bookkeeping starts over
+        this->frames_queued_.store(0, std::memory_order_relaxed);
+        this->frames_reported_.store(0, std::memory_order_relaxed);
+        this->padding_start_frame_.store(0, std::memory_order_relaxed);
+        this->padding_end_frame_.store(0, std::memory_order_relaxed);
         esp_err_t err = this->start_();
         if (err == ESP_OK) {
           this->callback_remainder_ = 0;  // reset callback remainder
@@ -234,10 +272,12 @@ size_t ResamplerSpeaker::play(const uint8_t *data, size_t length, TickType_t tic
   if ((this->output_speaker_->is_running()) && (!this->requires_resampling_())) {
     bytes_written = this->output_speaker_->play(data, length, ticks_to_wait);
   } else {
-    std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = this->ring_buffer_.lock();
+    std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
     if (temp_ring_buffer) {
       // Only write to the ring buffer if the reference is valid
-      bytes_written = temp_ring_buffer->write_without_replacement(data, length, ticks_to_wait);
+      bytes_written = temp_ring_buffer->write(data, length, ticks_to_wait);
+      this->frames_queued_.fetch_add(this->audio_stream_info_.bytes_to_frames(bytes_written),
+                                     std::memory_order_relaxed);
     } else {
       // Delay to avoid repeatedly hammering while waiting for the speaker to start
       vTaskDelay(ticks_to_wait);
@@ -247,6 +287,71 @@ size_t ResamplerSpeaker::play(const uint8_t *data, size_t length, TickType_t tic
   return bytes_written;
 }
 
+size_t ResamplerSpeaker::play_at(const uint8_t *data, size_t length, int64_t presentation_time_us) {
+  if (this->is_stopped()) {
+    this->start();
+  }
+
+  if (this->output_speaker_->is_running() && !this->requires_resampling_()) {
+    if (this->output_timed_speaker_ == nullptr) {
+      return this->output_speaker_->play(data, length, 0);
+    }
+    return this->output_timed_speaker_->play_at(data, length, presentation_time_us);
+  }
+
+  std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
+  if (!temp_ring_buffer) {
+    return 0;
+  }
+
+  const size_t bytes_per_frame = this->audio_stream_info_.frames_to_bytes(1);
+  const int64_t offset_us = presentation_time_us - this->get_next_presentation_time_us();
+  const int64_t offset_frames = offset_us * this->audio_stream_info_.get_sample_rate() / 1000000;
+
+  const uint64_t queued_frames = this->frames_queued_.load(std::memory_order_relaxed);
+  if (offset_frames < 0) {
+    // Already late; skip the part of the clip that should have played by now
+    const size_t skip_bytes = std::min<size_t>(-offset_frames * bytes_per_frame, length - length % bytes_per_frame);
+    const size_t bytes_written = temp_ring_buffer->write(data + skip_bytes, length - skip_bytes, 0);
+    this->frames_queued_.store(queued_frames + bytes_written / bytes_per_frame, std::memory_order_relaxed);
+    return skip_bytes + bytes_written;
+  }
+
+  if (offset_frames > 0) {
+    // Early; queue silence ahead of the clip. A gap longer than the ring's free space is queued over several calls,
+    // holding the clip back until all of it is in; each retry measures the remaining gap behind what is queued.
+    if (this->padding_end_frame_.load(std::memory_order_relaxed) != queued_frames) {
+      // Only one span of padding is tracked, so a new one waits until the output has played past the last
+      if (this->frames_reported_.load(std::memory_order_relaxed) <
+          this->padding_end_frame_.load(std::memory_order_relaxed)) {
+        return 0;
+      }
+      // Start before end: the callback reads the end first, so it never pairs the old start with the new end
+      this->padding_start_frame_.store(queued_frames, std::memory_order_relaxed);
+      this->padding_end_frame_.store(queued_frames, std::memory_order_release);
+    }
+
+    const size_t silence_frames = std::min<size_t>(offset_frames, temp_ring_buffer->free_frames());
+    // Published before the silence is queued, so the callback knows it is padding by the time any of it plays
+    this->padding_end_frame_.store(queued_frames + silence_frames, std::memory_order_release);
+    static const uint8_t SILENCE[64] = {0};
+    size_t silence_bytes = silence_frames * bytes_per_frame;
+    while (silence_bytes > 0) {
+      const size_t chunk = std::min(silence_bytes, sizeof(SILENCE) - sizeof(SILENCE) % bytes_per_frame);
+      temp_ring_buffer->write(SILENCE, chunk, 0);
+      silence_bytes -= chunk;
+    }
+    this->frames_queued_.store(queued_frames + silence_frames, std::memory_order_relaxed);
+    if (silence_frames < static_cast<size_t>(offset_frames)) {
+      return 0;
+    }
+  }
+
+  const size_t bytes_written = temp_ring_buffer->write(data, length, 0);
+  this->frames_queued_.fetch_add(bytes_written / bytes_per_frame, std::memory_order_relaxed);
+  return bytes_written;
+}
+
 void ResamplerSpeaker::send_command_(uint32_t command_bit, bool wake_loop) {
   this->enable_loop_soon_any_context();
   uint32_t event_bits = xEventGroupGetBits(this->event_group_);
@@ -289,6 +394,11 @@ void ResamplerSpeaker::enter_stopping_state_() {
   this->state_start_ms_ = App.get_loop_component_start_time();
   if (this->task_.is_created()) {
     xEventGroupSetBits(this->event_group_, ResamplingEventGroupBits::TASK_COMMAND_STOP);
+    std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
+    if (temp_ring_buffer) {
+      // The task only wakes for audio, so nudge it to see the command
+      temp_ring_buffer->wake_consumer();
+    }
   }
   this->output_speaker_->stop();
 }
@@ -296,14 +406,58 @@ void ResamplerSpeaker::enter_stopping_state_() {
 void ResamplerSpeaker::finish() { this->send_command_(ResamplingEventGroupBits::COMMAND_FINISH); }
 
 bool ResamplerSpeaker::has_buffered_data() const {
-  bool has_ring_buffer_data = false;
+  return (this->has_resampler_buffered_data_() || this->output_speaker_->has_buffered_data());
+}
+
+bool ResamplerSpeaker::has_resampler_buffered_data_() const {
+  if (!this->requires_resampling_()) {
+    return false;
+  }
+  // Checked in the order audio moves through the task, so audio in transit is seen in at least one place
+  bool has_buffered_data = false;
+  std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
+  if (temp_ring_buffer) {
+    has_buffered_data = (temp_ring_buffer->available() > 0);
+  }
+  std::shared_ptr<ring_buffer::RingBuffer> temp_staging_ring_buffer = this->staging_ring_buffer_.lock();
+  if (temp_staging_ring_buffer) {
+    has_buffered_data |= (temp_staging_ring_buffer->available() > 0);
+  }
+  return has_buffered_data || this->resampler_holds_audio_.load();
+}
+
+uint32_t ResamplerSpeaker::get_output_latency_us() const {
+  uint32_t latency_us = 0;
+  if (this->output_timed_speaker_ != nullptr) {
+    latency_us = this->output_timed_speaker_->get_output_latency_us();
+  }
+
   if (this->requires_resampling_()) {
-    std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = this->ring_buffer_.lock();
+    size_t buffered_bytes = 0;
+    std::shared_ptr<audio_ring::AudioRing> temp_ring_buffer = this->ring_buffer_.lock();
     if (temp_ring_buffer) {
-      has_ring_buffer_data = (temp_ring_buffer->available() > 0);
+      buffered_bytes += temp_ring_buffer->available();
+    }
+    std::shared_ptr<ring_buffer::RingBuffer> temp_staging_ring_buffer = this->staging_ring_buffer_.lock();
+    if (temp_staging_ring_buffer) {
+      buffered_bytes += temp_staging_ring_buffer->available();
+    }
+    latency_us +=
+        this->audio_stream_info_.frames_to_microseconds(this->audio_stream_info_.bytes_to_frames(buffered_bytes));
+    // The polyphase filters are symmetric, so they delay the signal by half their length
+    if (IntegerResampler::supports(this->audio_stream_info_, this->target_stream_info_)) {
+      latency_us += this->target_stream_info_.frames_to_microseconds(
+          IntegerResampler::latency_frames(this->audio_stream_info_, this->target_stream_info_));
+    } else {
+      latency_us += this->target_stream_info_.frames_to_microseconds(this->taps_ / 2);
     }
   }
-  return (has_ring_buffer_data || this->output_speaker_->has_buffered_data());
+
+  return latency_us;
+}
+
+int64_t ResamplerSpeaker::get_next_presentation_time_us() const {
+  return esp_timer_get_time() + this->get_output_latency_us();
 }
 
 void ResamplerSpeaker::set_mute_state(bool mute_state) {
@@ -331,25 +485,47 @@ void ResamplerSpeaker::resample_task(void *params) {
   xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::STATE_STARTING);
 
   {  // Ensure C++ objects fall out of scope for proper cleanup before stopping the task
-    std::unique_ptr<audio::AudioResampler> resampler = make_unique<audio::AudioResampler>(
-        this_resampler->audio_stream_info_.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS),
-        this_resampler->target_stream_info_.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS));
-
-    esp_err_t err = resampler->start(this_resampler->audio_stream_info_, this_resampler->target_stream_info_,
-                                     this_resampler->taps_, this_resampler->filters_);
+    const audio::AudioStreamInfo &input_stream_info = this_resampler->audio_stream_info_;
+    const audio::AudioStreamInfo &target_stream_info = this_resampler->target_stream_info_;
+
+    // Integer ratios run a fixed polyphase filter straight from the input ring into the output speaker; everything
+    // else goes through the general resampler and its staging ring
+    std::unique_ptr<IntegerResampler> integer_resampler;
+    std::unique_ptr<audio::AudioResampler> resampler;
+    std::vector<uint8_t> output_block;
+    esp_err_t err = ESP_OK;
+    if (IntegerResampler::supports(input_stream_info, target_stream_info)) {
+      ESP_LOGD(TAG, "Using the integer ratio resampler");
+      integer_resampler = make_unique<IntegerResampler>();
+      integer_resampler->start(input_stream_info, target_stream_info);
+      output_block.resize(target_stream_info.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS));
+    } else {
+      resampler = make_unique<audio::AudioResampler>(input_stream_info.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS),
+                                                     target_stream_info.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS));
+      err = resampler->start(this_resampler->audio_stream_info_, this_resampler->target_stream_info_,
+                             this_resampler->taps_, this_resampler->filters_);
+    }
 
+    std::shared_ptr<audio_ring::AudioRing> input_ring_buffer;
+    std::shared_ptr<ring_buffer::RingBuffer> staging_ring_buffer;
     if (err == ESP_OK) {
-      std::shared_ptr<ring_buffer::RingBuffer> temp_ring_buffer = ring_buffer::RingBuffer::create(
-          this_resampler->audio_stream_info_.ms_to_bytes(this_resampler->buffer_duration_ms_));
+      input_ring_buffer = audio_ring::AudioRing::create(
+          input_stream_info.ms_to_bytes(this_resampler->buffer_duration_ms_), input_stream_info.frames_to_bytes(1));
+      if (resampler != nullptr) {
+        staging_ring_buffer =
+            ring_buffer::RingBuffer::create(input_stream_info.ms_to_bytes(TRANSFER_BUFFER_DURATION_MS));
+      }
 
-      if (!temp_ring_buffer) {
+      if (!input_ring_buffer || ((resampler != nullptr) && !staging_ring_buffer)) {
         err = ESP_ERR_NO_MEM;
       } else {
-        this_resampler->ring_buffer_ = temp_ring_buffer;
-        resampler->add_source(this_resampler->ring_buffer_);
-
-        this_resampler->output_speaker_->set_audio_stream_info(this_resampler->target_stream_info_);
-        resampler->add_sink(this_resampler->output_speaker_);
+        this_resampler->ring_buffer_ = input_ring_buffer;
+        this_resampler->output_speaker_->set_audio_stream_info(target_stream_info);
+        if (resampler != nullptr) {
+          this_resampler->staging_ring_buffer_ = staging_ring_buffer;
+          resampler->add_source(this_resampler->staging_ring_buffer_);
+          resampler->add_sink(this_resampler->output_speaker_);
+        }
       }
     }
 
@@ -361,6 +537,16 @@ void ResamplerSpeaker::resample_task(void *params) {
       xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::ERR_ESP_NOT_SUPPORTED);
     }
 
+    // The task sleeps until play() has queued a block or a command wakes it, never on a timer while idle
+    const size_t input_block_frames = input_stream_info.ms_to_frames(INPUT_BLOCK_MS);
+
+    // Resampled audio the output speaker has not taken yet
+    size_t output_offset = 0;
+    size_t output_length = 0;
+
+    // Whether the AudioResampler and its staging ring are empty, so the task may sleep until more audio arrives
+    bool resampler_drained = true;
+
     while (err == ESP_OK) {
       uint32_t event_bits = xEventGroupGetBits(this_resampler->event_group_);
 
@@ -368,18 +554,59 @@ void ResamplerSpeaker::resample_task(void *params) {
         break;
       }
 
-      // Stop gracefully if the decoder is done
+      if (integer_resampler != nullptr) {
+        // The last input frames stay in the filter's history until silence pushes them out, so they count as held
+        this_resampler->resampler_holds_audio_.store((output_length > 0) || integer_resampler->has_tail());
+        if (output_length > 0) {
+          const size_t bytes_written = this_resampler->output_speaker_->play(
+              output_block.data() + output_offset, output_length, pdMS_TO_TICKS(OUTPUT_WAIT_MS));
+          output_offset += bytes_written;
+          output_length -= bytes_written;
+          continue;
+        }
+
+        if ((event_bits & ResamplingEventGroupBits::COMMAND_FINISH) && integer_resampler->has_tail() &&
+            (input_ring_buffer->available() == 0)) {
+          size_t output_frames = target_stream_info.bytes_to_frames(output_block.size());
+          integer_resampler->flush(output_block.data(), output_frames);
+          output_offset = 0;
+          output_length = target_stream_info.frames_to_bytes(output_frames);
+          continue;
+        }
+
+        input_ring_buffer->wait_for_block(input_block_frames, pdMS_TO_TICKS(INPUT_BLOCK_MS), portMAX_DELAY);
+        size_t input_frames = 0;
+        const uint8_t *input = input_ring_buffer->acquire_read(input_frames);
+        // Flagged before the frames leave the ring, so has_buffered_data() always finds them in one place or the other
+        this_resampler->resampler_holds_audio_.store(true);
+        size_t output_frames = target_stream_info.bytes_to_frames(output_block.size());
+        integer_resampler->process(input, input_frames, output_block.data(), output_frames);
+        input_ring_buffer->commit_read(input_frames);
+        output_offset = 0;
+        output_length = target_stream_info.frames_to_bytes(output_frames);
+        continue;
+      }
+
+      // While the resampler still holds audio, it is called again after a block's worth of waiting so the end of a
+      // stream reaches the output speaker instead of waiting in its transfer buffers for the next stream
+      stage_input(*input_ring_buffer, *staging_ring_buffer, input_block_frames, pdMS_TO_TICKS(INPUT_BLOCK_MS),
+                  resampler_drained ? portMAX_DELAY : pdMS_TO_TICKS(INPUT_BLOCK_MS));
+
+      // With stop_gracefully set, resample() reports FINISHED instead of running when neither its transfer buffers nor
+      // the staging ring hold any audio. The task keeps going; it only sleeps until play() queues more.
       int32_t ms_differential = 0;
-      audio::AudioResamplerState resampler_state = resampler->resample(false, &ms_differential);
+      this_resampler->resampler_holds_audio_.store(true);
+      audio::AudioResamplerState resampler_state = resampler->resample(true, &ms_differential);
+      resampler_drained = (resampler_state == audio::AudioResamplerState::FINISHED);
+      this_resampler->resampler_holds_audio_.store(!resampler_drained);
 
-      if (resampler_state == audio::AudioResamplerState::FINISHED) {
-        break;
-      } else if (resampler_state == audio::AudioResamplerState::FAILED) {
+      if (resampler_state == audio::AudioResamplerState::FAILED) {
         xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::ERR_ESP_FAIL);
         break;
       }
     }
 
+    this_resampler->resampler_holds_audio_.store(false);
     xEventGroupSetBits(this_resampler->event_group_, ResamplingEventGroupBits::STATE_STOPPING);
   }
 
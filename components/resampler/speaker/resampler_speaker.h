@@ -4,17 +4,21 @@
 
 #include "esphome/components/audio/audio.h"
 #include "esphome/components/audio/audio_transfer_buffer.h"
+#include "esphome/components/audio_ring/audio_ring.h"
 #include "esphome/components/ring_buffer/ring_buffer.h"
 #include "esphome/components/speaker/speaker.h"
+#include "esphome/components/timed_speaker/timed_speaker.h"
 
 #include "esphome/core/component.h"
 #include "esphome/core/static_task.h"
 
 #include <freertos/event_groups.h>
 
+#include <atomic>
+
 namespace esphome::resampler {
 
-class ResamplerSpeaker : public Component, public speaker::Speaker {
+class ResamplerSpeaker : public Component, public speaker::Speaker, public timed_speaker::TimedSpeaker {
  public:
   float get_setup_priority() const override { return esphome::setup_priority::DATA; }
   void dump_config() override;
@@ -41,7 +45,18 @@ class ResamplerSpeaker : public Component, public speaker::Speaker {
   void set_volume(float volume) override;
   float get_volume() override { return this->output_speaker_->get_volume(); }
 
+  /// @brief Latency of the output speaker (if it reports one) plus the audio buffered and delayed by the resampler
+  uint32_t get_output_latency_us() const override;
+  int64_t get_next_presentation_time_us() const override;
+
+  /// @brief Passed straight to a timed output speaker when no resampling is needed. Otherwise the clip is padded or
+  /// trimmed on the way into the resampler, using this speaker's own latency to the DAC. An early clip is held back
+  /// (0 is returned) until the silence in front of it is queued; that silence is not reported as played.
+  size_t play_at(const uint8_t *data, size_t length, int64_t presentation_time_us) override;
+
   void set_output_speaker(speaker::Speaker *speaker) { this->output_speaker_ = speaker; }
+  /// @brief Set when the output speaker implements TimedSpeaker so its latency can be included
+  void set_output_timed_speaker(timed_speaker::TimedSpeaker *speaker) { this->output_timed_speaker_ = speaker; }
   void set_task_stack_in_psram(bool task_stack_in_psram) { this->task_stack_in_psram_ = task_stack_in_psram; }
 
   void set_target_bits_per_sample(uint8_t target_bits_per_sample) {
@@ -77,14 +92,31 @@ class ResamplerSpeaker : public Component, public speaker::Speaker {
   /// @brief Sends a command via event group bits, enables the loop, and optionally wakes the main loop.
   void send_command_(uint32_t command_bit, bool wake_loop = false);
 
+  /// @brief True while audio play() queued has not reached the output speaker yet: it is in the input or staging ring,
+  /// or the task's resampler still holds it.
+  bool has_resampler_buffered_data_() const;
+
   inline bool requires_resampling_() const;
   static void resample_task(void *params);
 
   EventGroupHandle_t event_group_{nullptr};
 
-  std::weak_ptr<ring_buffer::RingBuffer> ring_buffer_;
+  // Audio queued by play(), handed lock-free to the task
+  std::weak_ptr<audio_ring::AudioRing> ring_buffer_;
+  // The task's staging ring feeding the AudioResampler, which only reads from a ring_buffer::RingBuffer
+  std::weak_ptr<ring_buffer::RingBuffer> staging_ring_buffer_;
+  // Set by the task while its resampler holds audio that is in neither ring
+  std::atomic<bool> resampler_holds_audio_{false};
+
+  // play_at() padding, in input frames counted along everything queued into the input ring. The producer advances
+  // frames_queued_ and the padding span; the output callback advances frames_reported_ and leaves the span unreported.
+  std::atomic<uint64_t> frames_queued_{0};
+  std::atomic<uint64_t> frames_reported_{0};
+  std::atomic<uint64_t> padding_start_frame_{0};
+  std::atomic<uint64_t> padding_end_frame_{0};
 
   speaker::Speaker *output_speaker_{nullptr};
+  timed_speaker::TimedSpeaker *output_timed_speaker_{nullptr};
 
   StaticTask task_;
 
@@ -0,0 +1,144 @@
+import esphome.codegen as cg
+from esphome.components import audio, psram, sensor, speaker
+from esphome.components.timed_speaker import TimedSpeaker
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+    CONF_NUM_CHANNELS,
+    CONF_PORT,
+    CONF_SAMPLE_RATE,
+    CONF_SPEAKER,
+    CONF_TASK_STACK_IN_PSRAM,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    PLATFORM_ESP32,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+)
+
+AUTO_LOAD = ["audio", "sensor", "timed_speaker"]
+DEPENDENCIES = ["network"]
+MULTI_CONF = True
+
+rtp_audio_ns = cg.esphome_ns.namespace("rtp_audio")
+RtpAudio = rtp_audio_ns.class_("RtpAudio", cg.Component)
+
+CONF_PAYLOAD_TYPE = "payload_type"
+CONF_ENCODING = "encoding"
+CONF_MIN_DELAY = "min_delay"
+CONF_MAX_DELAY = "max_delay"
+CONF_IDLE_TIMEOUT = "idle_timeout"
+CONF_JITTER_SENSOR = "jitter_sensor"
+CONF_PACKET_LOSS_SENSOR = "packet_loss_sensor"
+CONF_LATENCY_SENSOR = "latency_sensor"
+
+# RTP payload formats (RFC 3551), by bits per sample
+ENCODINGS = {
+    "L16": 16,
+    "L24": 24,
+}
+
+
+def _validate_delays(config):
+    if config[CONF_MAX_DELAY] < config[CONF_MIN_DELAY]:
+        raise cv.Invalid(f"{CONF_MAX_DELAY} must not be less than {CONF_MIN_DELAY}")
+    return config
+
+
+def _validate_audio_compatibility(config):
+    audio.final_validate_audio_schema(
+        "rtp_audio",
+        audio_device=CONF_SPEAKER,
+        bits_per_sample=ENCODINGS[config[CONF_ENCODING]],
+        channels=config[CONF_NUM_CHANNELS],
+        sample_rate=config[CONF_SAMPLE_RATE],
+    )(config)
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(RtpAudio),
+            cv.Required(CONF_SPEAKER): cv.use_id(speaker.Speaker),
+            cv.Optional(CONF_PORT, default=5004): cv.port,
+            cv.Optional(CONF_PAYLOAD_TYPE, default=96): cv.int_range(min=0, max=127),
+            cv.Optional(CONF_ENCODING, default="L16"): cv.one_of(
+                *ENCODINGS, upper=True
+            ),
+            cv.Optional(CONF_SAMPLE_RATE, default=48000): cv.int_range(
+                min=8000, max=96000
+            ),
+            cv.Optional(CONF_NUM_CHANNELS, default=1): cv.int_range(min=1, max=2),
+            cv.Optional(
+                CONF_MIN_DELAY, default="20ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(
+                CONF_MAX_DELAY, default="200ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(
+                CONF_IDLE_TIMEOUT, default="1s"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_TASK_STACK_IN_PSRAM): psram.validate_task_stack_in_psram,
+            cv.Optional(CONF_JITTER_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_PACKET_LOSS_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_LATENCY_SENSOR): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    cv.only_on([PLATFORM_ESP32]),
+    _validate_delays,
+)
+
+
+FINAL_VALIDATE_SCHEMA = _validate_audio_compatibility
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    speaker_id, spkr = await cg.get_variable_with_full_id(config[CONF_SPEAKER])
+    cg.add(var.set_speaker(spkr))
+    if speaker_id.type.inherits_from(TimedSpeaker):
+        cg.add(var.set_timed_speaker(spkr))
+
+    cg.add(var.set_port(config[CONF_PORT]))
+    cg.add(var.set_payload_type(config[CONF_PAYLOAD_TYPE]))
+    cg.add(
+        var.set_stream_format(
+            ENCODINGS[config[CONF_ENCODING]],
+            config[CONF_NUM_CHANNELS],
+            config[CONF_SAMPLE_RATE],
+        )
+    )
+    cg.add(var.set_min_delay(config[CONF_MIN_DELAY]))
+    cg.add(var.set_max_delay(config[CONF_MAX_DELAY]))
+    cg.add(var.set_idle_timeout(config[CONF_IDLE_TIMEOUT]))
+
+    if config.get(CONF_TASK_STACK_IN_PSRAM):
+        cg.add(var.set_task_stack_in_psram(True))
+        psram.request_external_task_stack()
+
+    if conf := config.get(CONF_JITTER_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_jitter_sensor(sens))
+    if conf := config.get(CONF_PACKET_LOSS_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_packet_loss_sensor(sens))
+    if conf := config.get(CONF_LATENCY_SENSOR):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_latency_sensor(sens))
@@ -0,0 +1,235 @@
+#include "rtp_audio.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+
+#include <cinttypes>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+namespace esphome::rtp_audio {
+
+static const char *const TAG = "rtp_audio";
+
+// Just below the lwIP task, so received datagrams are handed over without waiting behind it
+static const UBaseType_t RECEIVE_TASK_PRIORITY = 17;
+
+static const uint32_t TASK_STACK_SIZE = 4096;
+
+// Longest the task blocks in recv(); bounds how late a lost packet is noticed and concealed
+static const uint32_t RECEIVE_TIMEOUT_MS = 5;
+
+static const size_t MAX_DATAGRAM_SIZE = 1500;
+
+// How far the speaker may drift from the stream's timeline before a block is re-scheduled with play_at()
+static const int64_t RESCHEDULE_TOLERANCE_US = 5000;
+
+static const uint32_t SENSOR_PUBLISH_INTERVAL_MS = 10000;
+
+enum RtpEventGroupBits : uint32_t {
+  STREAM_STARTED = (1 << 0),  // packets are arriving but the speaker is stopped; loop() starts it
+  STREAM_IDLE = (1 << 1),     // no packets for the idle timeout; loop() lets the speaker finish
+  ERR_SOCKET = (1 << 20),
+  ALL_BITS = 0x00FFFFFF,  // All valid FreeRTOS event group bits
+};
+
+void RtpAudio::dump_config() {
+  ESP_LOGCONFIG(TAG,
+                "RTP Audio:\n"
+                "  Port: %" PRIu16 "\n"
+                "  Payload Type: %" PRIu8 "\n"
+                "  Encoding: L%" PRIu8 "\n"
+                "  Sample Rate: %" PRIu32 " Hz\n"
+                "  Channels: %" PRIu8 "\n"
+                "  Jitter Buffer: %" PRIu32 " to %" PRIu32 " ms\n"
+                "  Idle Timeout: %" PRIu32 " ms",
+                this->port_, this->payload_type_, this->audio_stream_info_.get_bits_per_sample(),
+                this->audio_stream_info_.get_sample_rate(), this->audio_stream_info_.get_channels(),
+                this->min_delay_ms_, this->max_delay_ms_, this->idle_timeout_ms_);
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "Jitter", this->jitter_sensor_);
+  LOG_SENSOR("  ", "Packet loss", this->packet_loss_sensor_);
+  LOG_SENSOR("  ", "Latency", this->latency_sensor_);
+#endif
+}
+
+void RtpAudio::setup() {
+  this->event_group_ = xEventGroupCreate();
+  if (this->event_group_ == nullptr) {
+    ESP_LOGE(TAG, "Failed to create event group");
+    this->mark_failed();
+    return;
+  }
+
+  if (!this->jitter_buffer_.configure(this->audio_stream_info_.get_sample_rate(),
+                                      this->audio_stream_info_.get_channels(),
+                                      this->audio_stream_info_.samples_to_bytes(1), this->min_delay_ms_,
+                                      this->max_delay_ms_)) {
+    ESP_LOGE(TAG, "Failed to allocate the jitter buffer");
+    this->mark_failed();
+    return;
+  }
+
+  if (!this->task_.create(receive_task, "rtp_audio", TASK_STACK_SIZE, (void *) this, RECEIVE_TASK_PRIORITY,
+                          this->task_stack_in_psram_)) {
+    ESP_LOGE(TAG, "Failed to create the receive task");
+    this->mark_failed();
+  }
+}
+
+void RtpAudio::loop() {
+  const uint32_t event_group_bits = xEventGroupGetBits(this->event_group_);
+
+  if (event_group_bits & RtpEventGroupBits::ERR_SOCKET) {
+    this->status_set_error(LOG_STR("Failed to open UDP socket"));
+    xEventGroupClearBits(this->event_group_, RtpEventGroupBits::ERR_SOCKET);
+  }
+  if (event_group_bits & RtpEventGroupBits::STREAM_STARTED) {
+    xEventGroupClearBits(this->event_group_, RtpEventGroupBits::STREAM_STARTED);
+    if (this->speaker_->is_stopped()) {
+      ESP_LOGD(TAG, "Stream started");
+      this->speaker_->set_audio_stream_info(this->audio_stream_info_);
+      this->speaker_->start();
+    }
+  }
+  if (event_group_bits & RtpEventGroupBits::STREAM_IDLE) {
+    xEventGroupClearBits(this->event_group_, RtpEventGroupBits::STREAM_IDLE);
+    ESP_LOGD(TAG, "Stream idle");
+    this->speaker_->finish();
+  }
+
+#ifdef USE_SENSOR
+  const uint32_t now = millis();
+  if (now - this->last_sensor_publish_ms_ >= SENSOR_PUBLISH_INTERVAL_MS) {
+    this->last_sensor_publish_ms_ = now;
+    const uint32_t received_packets = this->received_packets_.load(std::memory_order_relaxed);
+    const uint32_t lost_packets = this->lost_packets_.load(std::memory_order_relaxed);
+    const uint32_t received = received_packets - this->published_received_packets_;
+    const uint32_t lost = lost_packets - this->published_lost_packets_;
+    this->published_received_packets_ = received_packets;
+    this->published_lost_packets_ = lost_packets;
+
+    if ((this->packet_loss_sensor_ != nullptr) && (received + lost > 0)) {
+      this->packet_loss_sensor_->publish_state(lost * 100.0f / (received + lost));
+    }
+    if (this->jitter_sensor_ != nullptr) {
+      this->jitter_sensor_->publish_state(this->jitter_us_.load(std::memory_order_relaxed) / 1000.0f);
+    }
+    if ((this->latency_sensor_ != nullptr) && (received > 0)) {
+      this->latency_sensor_->publish_state(this->latency_us_.load(std::memory_order_relaxed) / 1000.0f);
+    }
+  }
+#endif
+}
+
+bool RtpAudio::write_pending_() {
+  const PlayoutBlock &block = this->pending_block_;
+  if (this->pending_offset_ >= block.bytes) {
+    return true;
+  }
+
+  size_t written = 0;
+  if ((this->pending_offset_ == 0) && (this->timed_speaker_ != nullptr)) {
+    if (!this->scheduled_) {
+      // Nothing of this stream is queued yet, so this is the speaker's own latency
+      this->output_delay_us_ = this->timed_speaker_->get_output_latency_us();
+    }
+    const int64_t presentation_us = block.presentation_us + this->output_delay_us_;
+    const int64_t next_presentation_us = this->timed_speaker_->get_next_presentation_time_us();
+    if (!this->scheduled_ || (std::llabs(next_presentation_us - presentation_us) > RESCHEDULE_TOLERANCE_US)) {
+      written = this->timed_speaker_->play_at(block.data, block.bytes, presentation_us);
+      this->scheduled_ = (written > 0);
+    } else {
+      written = this->speaker_->play(block.data, block.bytes, 0);
+    }
+    if ((written > 0) && (block.arrival_us != 0)) {
+      this->latency_us_.store(static_cast<uint32_t>(presentation_us - block.arrival_us), std::memory_order_relaxed);
+    }
+  } else {
+    written = this->speaker_->play(block.data + this->pending_offset_, block.bytes - this->pending_offset_, 0);
+  }
+
+  this->pending_offset_ += written;
+  return this->pending_offset_ >= block.bytes;
+}
+
+void RtpAudio::receive_task(void *params) {
+  RtpAudio *this_rtp = static_cast<RtpAudio *>(params);
+
+  std::unique_ptr<uint8_t[]> datagram(new (std::nothrow) uint8_t[MAX_DATAGRAM_SIZE]);
+  const int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(this_rtp->port_);
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  if ((datagram == nullptr) || (sock < 0) ||
+      (bind(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)) {
+    if (sock >= 0) {
+      close(sock);
+    }
+    xEventGroupSetBits(this_rtp->event_group_, RtpEventGroupBits::ERR_SOCKET);
+    vTaskSuspend(nullptr);
+  }
+
+  timeval timeout{};
+  timeout.tv_usec = RECEIVE_TIMEOUT_MS * 1000;
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  RtpJitterBuffer &jitter_buffer = this_rtp->jitter_buffer_;
+  bool streaming = false;
+  int64_t last_packet_us = 0;
+
+  while (true) {
+    const ssize_t received = recv(sock, datagram.get(), MAX_DATAGRAM_SIZE, 0);
+    const int64_t now_us = esp_timer_get_time();
+
+    RtpPacket packet;
+    if ((received > 0) && parse_rtp_packet(datagram.get(), received, packet) &&
+        (packet.payload_type == this_rtp->payload_type_)) {
+      jitter_buffer.insert(packet, now_us);
+      last_packet_us = now_us;
+      streaming = true;
+    }
+
+    if (!streaming) {
+      continue;
+    }
+
+    if (now_us - last_packet_us > static_cast<int64_t>(this_rtp->idle_timeout_ms_) * 1000) {
+      streaming = false;
+      jitter_buffer.reset();
+      this_rtp->pending_block_ = PlayoutBlock();
+      this_rtp->pending_offset_ = 0;
+      this_rtp->scheduled_ = false;
+      xEventGroupSetBits(this_rtp->event_group_, RtpEventGroupBits::STREAM_IDLE);
+      continue;
+    }
+
+    if (!this_rtp->speaker_->is_running()) {
+      // Hold the packets until the speaker is ready, then start the timeline from the oldest one
+      if (this_rtp->speaker_->is_stopped()) {
+        xEventGroupSetBits(this_rtp->event_group_, RtpEventGroupBits::STREAM_STARTED);
+      }
+      jitter_buffer.rebase(now_us);
+      this_rtp->scheduled_ = false;
+    } else {
+      while (this_rtp->write_pending_() && jitter_buffer.pop(now_us, this_rtp->pending_block_)) {
+        this_rtp->pending_offset_ = 0;
+      }
+    }
+
+    this_rtp->received_packets_.store(jitter_buffer.get_received_packets(), std::memory_order_relaxed);
+    this_rtp->lost_packets_.store(jitter_buffer.get_lost_packets(), std::memory_order_relaxed);
+    this_rtp->jitter_us_.store(jitter_buffer.get_jitter_us(), std::memory_order_relaxed);
+  }
+}
+
+}  // namespace esphome::rtp_audio
+
+#endif  // USE_ESP32
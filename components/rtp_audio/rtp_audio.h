@@ -0,0 +1,97 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "rtp_jitter_buffer.h"
+
+#include "esphome/components/audio/audio.h"
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+#include "esphome/components/speaker/speaker.h"
+#include "esphome/components/timed_speaker/timed_speaker.h"
+
+#include "esphome/core/component.h"
+#include "esphome/core/static_task.h"
+
+#include <freertos/event_groups.h>
+
+#include <atomic>
+
+namespace esphome::rtp_audio {
+
+/// @brief Receives RTP L16 or L24 audio over UDP (RFC 3551) and plays it on a speaker, bypassing the media player's
+/// decoding and buffering. A receive task reorders packets and conceals losses in an adaptive jitter buffer, then
+/// writes each packet with its presentation time, so a timed speaker holds the stream at a fixed, measurable latency
+/// behind the sender.
+class RtpAudio : public Component {
+ public:
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+  void dump_config() override;
+  void setup() override;
+  void loop() override;
+
+  void set_speaker(speaker::Speaker *speaker) { this->speaker_ = speaker; }
+  /// @brief Set when the speaker implements TimedSpeaker, so packets are played at their presentation time
+  void set_timed_speaker(timed_speaker::TimedSpeaker *speaker) { this->timed_speaker_ = speaker; }
+
+  void set_port(uint16_t port) { this->port_ = port; }
+  void set_payload_type(uint8_t payload_type) { this->payload_type_ = payload_type; }
+  void set_stream_format(uint8_t bits_per_sample, uint8_t channels, uint32_t sample_rate) {
+    this->audio_stream_info_ = audio::AudioStreamInfo(bits_per_sample, channels, sample_rate);
+  }
+  void set_min_delay(uint32_t min_delay_ms) { this->min_delay_ms_ = min_delay_ms; }
+  void set_max_delay(uint32_t max_delay_ms) { this->max_delay_ms_ = max_delay_ms; }
+  void set_idle_timeout(uint32_t idle_timeout_ms) { this->idle_timeout_ms_ = idle_timeout_ms; }
+  void set_task_stack_in_psram(bool task_stack_in_psram) { this->task_stack_in_psram_ = task_stack_in_psram; }
+
+#ifdef USE_SENSOR
+  SUB_SENSOR(jitter)
+  SUB_SENSOR(packet_loss)
+  SUB_SENSOR(latency)
+#endif
+
+ protected:
+  static void receive_task(void *params);
+
+  /// @brief Writes the pending block to the speaker, scheduling it at its presentation time if the speaker has
+  /// drifted off the stream's timeline. Only called from the receive task.
+  /// @return True once the whole block has been written
+  bool write_pending_();
+
+  EventGroupHandle_t event_group_{nullptr};
+  StaticTask task_;
+
+  speaker::Speaker *speaker_{nullptr};
+  timed_speaker::TimedSpeaker *timed_speaker_{nullptr};
+
+  audio::AudioStreamInfo audio_stream_info_;
+  uint32_t min_delay_ms_{20};
+  uint32_t max_delay_ms_{200};
+  uint32_t idle_timeout_ms_{1000};
+  uint16_t port_{5004};
+  uint8_t payload_type_{96};
+  bool task_stack_in_psram_{false};
+
+  // Owned by the receive task
+  RtpJitterBuffer jitter_buffer_;
+  PlayoutBlock pending_block_;  // block being written to the speaker; its data lives in the jitter buffer
+  size_t pending_offset_{0};
+  int64_t output_delay_us_{0};  // speaker latency when the stream started, added to every presentation time
+  bool scheduled_{false};       // the speaker has been placed on the stream's timeline
+
+  // Statistics written by the receive task and published by loop()
+  std::atomic<uint32_t> received_packets_{0};
+  std::atomic<uint32_t> lost_packets_{0};
+  std::atomic<uint32_t> jitter_us_{0};
+  std::atomic<uint32_t> latency_us_{0};
+#ifdef USE_SENSOR
+  uint32_t published_received_packets_{0};
+  uint32_t published_lost_packets_{0};
+  uint32_t last_sensor_publish_ms_{0};
+#endif
+};
+
+}  // namespace esphome::rtp_audio
+
+#endif  // USE_ESP32
@@ -0,0 +1,299 @@
+#include "rtp_jitter_buffer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace esphome::rtp_audio {
+
+static constexpr size_t RTP_HEADER_SIZE = 12;
+
+// Multiple of the jitter estimate added to the packet duration for the playout delay. Four times the mean deviation
+// covers nearly all arrivals when delays are roughly normally distributed.
+static constexpr uint32_t JITTER_DELAY_FACTOR = 4;
+
+// Smoothing of the RFC 3550 jitter estimate and of the transit time used to follow sender clock drift
+static constexpr int32_t JITTER_SMOOTHING = 16;
+static constexpr int32_t DRIFT_SMOOTHING = 64;
+
+// Distance in seconds from the anchor after which the timeline is re-based, keeping the timestamp difference small
+static constexpr int32_t ANCHOR_REBASE_SECONDS = 60;
+
+static uint32_t read_be32(const uint8_t *p) {
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+bool parse_rtp_packet(const uint8_t *data, size_t size, RtpPacket &packet) {
+  if ((size < RTP_HEADER_SIZE) || ((data[0] >> 6) != 2)) {
+    return false;
+  }
+
+  const bool padding = data[0] & 0x20;
+  const bool extension = data[0] & 0x10;
+  size_t header_size = RTP_HEADER_SIZE + 4 * (data[0] & 0x0F);
+  if (extension) {
+    if (size < header_size + 4) {
+      return false;
+    }
+    header_size += 4 + 4 * ((static_cast<size_t>(data[header_size + 2]) << 8) | data[header_size + 3]);
+  }
+  if (size < header_size) {
+    return false;
+  }
+
+  size_t end = size;
+  if (padding) {
+    const uint8_t padding_size = data[size - 1];
+    if ((padding_size == 0) || (padding_size > end - header_size)) {
+      return false;
+    }
+    end -= padding_size;
+  }
+
+  packet.marker = data[1] & 0x80;
+  packet.payload_type = data[1] & 0x7F;
+  packet.sequence = (static_cast<uint16_t>(data[2]) << 8) | data[3];
+  packet.timestamp = read_be32(data + 4);
+  packet.ssrc = read_be32(data + 8);
+  packet.payload = data + header_size;
+  packet.payload_size = end - header_size;
+  return true;
+}
+
+bool RtpJitterBuffer::configure(uint32_t sample_rate, uint8_t channels, uint8_t bytes_per_sample,
+                                uint32_t min_delay_ms, uint32_t max_delay_ms) {
+  if ((sample_rate == 0) || (channels == 0) || ((bytes_per_sample != 2) && (bytes_per_sample != 3))) {
+    return false;
+  }
+
+  this->storage_.reset(new (std::nothrow) uint8_t[SLOTS * MAX_PAYLOAD_SIZE]);
+  this->last_payload_.reset(new (std::nothrow) uint8_t[MAX_PAYLOAD_SIZE]);
+  if ((this->storage_ == nullptr) || (this->last_payload_ == nullptr)) {
+    return false;
+  }
+
+  this->sample_rate_ = sample_rate;
+  this->bytes_per_sample_ = bytes_per_sample;
+  this->bytes_per_frame_ = bytes_per_sample * channels;
+  this->min_delay_us_ = min_delay_ms * 1000;
+  this->max_delay_us_ = std::max(min_delay_ms, max_delay_ms) * 1000;
+  this->target_delay_us_ = this->min_delay_us_;
+  this->reset();
+  return true;
+}
+
+void RtpJitterBuffer::reset() {
+  for (Slot &slot : this->slots_) {
+    slot.filled = false;
+  }
+  this->last_payload_bytes_ = 0;
+  this->concealed_in_row_ = 0;
+  this->started_ = false;
+  this->waiting_ = false;
+}
+
+void RtpJitterBuffer::start_(const RtpPacket &packet, int64_t arrival_us) {
+  for (Slot &slot : this->slots_) {
+    slot.filled = false;
+  }
+  this->ssrc_ = packet.ssrc;
+  this->next_sequence_ = packet.sequence;
+  this->next_timestamp_ = packet.timestamp;
+  this->anchor_timestamp_ = packet.timestamp;
+  this->anchor_us_ = arrival_us;
+  this->frames_per_packet_ = packet.payload_size / this->bytes_per_frame_;
+  this->last_transit_us_ = 0;
+  this->drift_us_ = 0;
+  this->concealed_in_row_ = 0;
+  this->started_ = true;
+  this->waiting_ = false;
+
+  this->target_delay_us_ = std::clamp(this->packet_duration_us_() + JITTER_DELAY_FACTOR * this->jitter_us_,
+                                      this->min_delay_us_, this->max_delay_us_);
+}
+
+bool RtpJitterBuffer::insert(const RtpPacket &packet, int64_t arrival_us) {
+  if ((this->storage_ == nullptr) || (packet.payload_size == 0) || (packet.payload_size > MAX_PAYLOAD_SIZE) ||
+      (packet.payload_size % this->bytes_per_frame_ != 0)) {
+    return false;
+  }
+
+  if (this->started_ && (packet.ssrc != this->ssrc_)) {
+    // A different sender; its network path has nothing to do with the previous one's
+    this->jitter_us_ = 0;
+    this->start_(packet, arrival_us);
+  } else if (!this->is_active()) {
+    this->start_(packet, arrival_us);
+  } else {
+    const int16_t ahead = static_cast<int16_t>(packet.sequence - this->next_sequence_);
+    if (ahead < 0) {
+      // Already played or concealed; play later from now on so the next one like it is caught
+      ++this->late_packets_;
+      this->target_delay_us_ = std::min(this->max_delay_us_, this->target_delay_us_ + this->packet_duration_us_());
+      return false;
+    }
+    if (ahead >= static_cast<int16_t>(SLOTS)) {
+      // Too far ahead to reorder: the sender restarted or a long burst was lost
+      this->start_(packet, arrival_us);
+    }
+  }
+
+  const size_t index = packet.sequence % SLOTS;
+  Slot &slot = this->slots_[index];
+  if (slot.filled && (slot.sequence == packet.sequence)) {
+    return false;
+  }
+
+  if (static_cast<int32_t>(packet.timestamp - this->anchor_timestamp_) >
+      static_cast<int32_t>(this->sample_rate_) * ANCHOR_REBASE_SECONDS) {
+    this->anchor_us_ = this->expected_us_(packet.timestamp);
+    this->anchor_timestamp_ = packet.timestamp;
+  }
+
+  // Interarrival jitter as in RFC 3550 section 6.4.1, kept in microseconds
+  const int32_t transit_us = static_cast<int32_t>(arrival_us - this->expected_us_(packet.timestamp));
+  const int32_t jitter = static_cast<int32_t>(this->jitter_us_);
+  this->jitter_us_ = jitter + (std::abs(transit_us - this->last_transit_us_) - jitter) / JITTER_SMOOTHING;
+  this->last_transit_us_ = transit_us;
+
+  // A sender clock running fast or slow against ours shows up as a steady trend in the transit time. Shift the
+  // timeline once the trend exceeds half the playout delay, so buffering neither grows nor runs out.
+  this->drift_us_ += (transit_us - this->drift_us_) / DRIFT_SMOOTHING;
+  const int32_t drift_limit_us =
+      static_cast<int32_t>(std::max(this->packet_duration_us_(), this->target_delay_us_ / 2));
+  if (std::abs(this->drift_us_) > drift_limit_us) {
+    this->anchor_us_ += this->drift_us_;
+    this->last_transit_us_ -= this->drift_us_;
+    this->drift_us_ = 0;
+  }
+
+  // Store the samples little-endian, ready for the speaker
+  uint8_t *destination = this->storage_.get() + index * MAX_PAYLOAD_SIZE;
+  if (this->bytes_per_sample_ == 2) {
+    for (size_t i = 0; i < packet.payload_size; i += 2) {
+      destination[i] = packet.payload[i + 1];
+      destination[i + 1] = packet.payload[i];
+    }
+  } else {
+    for (size_t i = 0; i < packet.payload_size; i += 3) {
+      destination[i] = packet.payload[i + 2];
+      destination[i + 1] = packet.payload[i + 1];
+      destination[i + 2] = packet.payload[i];
+    }
+  }
+
+  slot.arrival_us = arrival_us;
+  slot.timestamp = packet.timestamp;
+  slot.sequence = packet.sequence;
+  slot.bytes = packet.payload_size;
+  slot.filled = true;
+  this->frames_per_packet_ = packet.payload_size / this->bytes_per_frame_;
+  ++this->received_packets_;
+  return true;
+}
+
+bool RtpJitterBuffer::pop(int64_t now_us, PlayoutBlock &block) {
+  if (!this->is_active()) {
+    return false;
+  }
+
+  Slot &slot = this->slots_[this->next_sequence_ % SLOTS];
+  if (slot.filled && (slot.sequence == this->next_sequence_)) {
+    // Copied out so the block outlives the slot and can be repeated if the next packet is lost
+    std::memcpy(this->last_payload_.get(), this->storage_.get() + (this->next_sequence_ % SLOTS) * MAX_PAYLOAD_SIZE,
+                slot.bytes);
+    this->last_payload_bytes_ = slot.bytes;
+    slot.filled = false;
+
+    block.data = this->last_payload_.get();
+    block.bytes = slot.bytes;
+    block.presentation_us = this->expected_us_(slot.timestamp) + this->target_delay_us_;
+    block.arrival_us = slot.arrival_us;
+    block.concealed = false;
+
+    ++this->next_sequence_;
+    this->next_timestamp_ = slot.timestamp + slot.bytes / this->bytes_per_frame_;
+    this->concealed_in_row_ = 0;
+    return true;
+  }
+
+  const int64_t presentation_us = this->expected_us_(this->next_timestamp_) + this->target_delay_us_;
+  if (now_us < presentation_us) {
+    // Still time for it to arrive
+    return false;
+  }
+
+  if (this->concealed_in_row_ >= MAX_CONCEALED_PACKETS) {
+    // A long gap. Resume from the oldest packet already buffered, if any, otherwise end the talkspurt.
+    int16_t nearest = static_cast<int16_t>(SLOTS);
+    for (const Slot &candidate : this->slots_) {
+      const int16_t ahead = static_cast<int16_t>(candidate.sequence - this->next_sequence_);
+      if (candidate.filled && (ahead > 0) && (ahead < nearest)) {
+        nearest = ahead;
+      }
+    }
+    if (nearest == static_cast<int16_t>(SLOTS)) {
+      this->waiting_ = true;
+      return false;
+    }
+    const Slot &resume = this->slots_[(this->next_sequence_ + nearest) % SLOTS];
+    this->lost_packets_ += nearest;
+    this->next_sequence_ = resume.sequence;
+    this->next_timestamp_ = resume.timestamp;
+    this->concealed_in_row_ = 0;
+    return this->pop(now_us, block);
+  }
+
+  if (this->last_payload_bytes_ == 0) {
+    this->last_payload_bytes_ =
+        std::min<size_t>(this->frames_per_packet_ * this->bytes_per_frame_, MAX_PAYLOAD_SIZE);
+    std::memset(this->last_payload_.get(), 0, this->last_payload_bytes_);
+  }
+
+  // Repeat the previous block 6 dB quieter each time
+  uint8_t *payload = this->last_payload_.get();
+  if (this->bytes_per_sample_ == 2) {
+    for (size_t i = 0; i < this->last_payload_bytes_; i += 2) {
+      const int16_t sample = static_cast<int16_t>(payload[i] | (payload[i + 1] << 8)) >> 1;
+      payload[i] = static_cast<uint8_t>(sample);
+      payload[i + 1] = static_cast<uint8_t>(sample >> 8);
+    }
+  } else {
+    for (size_t i = 0; i < this->last_payload_bytes_; i += 3) {
+      const uint32_t packed = (static_cast<uint32_t>(payload[i]) << 8) |
+                              (static_cast<uint32_t>(payload[i + 1]) << 16) |
+                              (static_cast<uint32_t>(payload[i + 2]) << 24);
+      // Back down to 24 bits and halved in one arithmetic shift
+      const int32_t sample = static_cast<int32_t>(packed) >> 9;
+      payload[i] = static_cast<uint8_t>(sample);
+      payload[i + 1] = static_cast<uint8_t>(sample >> 8);
+      payload[i + 2] = static_cast<uint8_t>(sample >> 16);
+    }
+  }
+
+  block.data = payload;
+  block.bytes = this->last_payload_bytes_;
+  block.presentation_us = presentation_us;
+  block.arrival_us = 0;
+  block.concealed = true;
+
+  ++this->lost_packets_;
+  ++this->concealed_in_row_;
+  ++this->next_sequence_;
+  this->next_timestamp_ += this->last_payload_bytes_ / this->bytes_per_frame_;
+  return true;
+}
+
+void RtpJitterBuffer::rebase(int64_t now_us) {
+  if (!this->started_) {
+    return;
+  }
+  this->anchor_timestamp_ = this->next_timestamp_;
+  this->anchor_us_ = now_us;
+  this->last_transit_us_ = 0;
+  this->drift_us_ = 0;
+}
+
+}  // namespace esphome::rtp_audio
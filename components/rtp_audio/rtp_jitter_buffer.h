@@ -0,0 +1,130 @@
+#pragma once
+
+// No ESP-IDF dependencies, so the parser and jitter buffer also build on a Linux host, where
+// tests/host/rtp_jitter_buffer_loopback runs them against a simulated sender and network
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome::rtp_audio {
+
+/// @brief Fields of an RTP packet (RFC 3550) used for playout. `payload` points into the received datagram.
+struct RtpPacket {
+  const uint8_t *payload{nullptr};
+  size_t payload_size{0};
+  uint32_t timestamp{0};
+  uint32_t ssrc{0};
+  uint16_t sequence{0};
+  uint8_t payload_type{0};
+  bool marker{false};
+};
+
+/// @brief Parses an RTP header, skipping any CSRC list, header extension and padding.
+/// @return False if the datagram is not well-formed RTP version 2
+bool parse_rtp_packet(const uint8_t *data, size_t size, RtpPacket &packet);
+
+/// @brief One packet's worth of little-endian PCM released by the jitter buffer.
+struct PlayoutBlock {
+  const uint8_t *data{nullptr};
+  size_t bytes{0};
+  int64_t presentation_us{0};  // when the first frame should be heard, before the output's own latency is added
+  int64_t arrival_us{0};       // when the packet arrived; 0 for concealed blocks
+  bool concealed{false};       // synthesized for a packet that never arrived
+};
+
+/// @brief Reorders RTP L16/L24 packets and releases them in sequence with a presentation time derived from their RTP
+/// timestamps. The playout delay follows the RFC 3550 interarrival jitter estimate within the configured limits: it is
+/// recomputed whenever the timeline is re-anchored and raised straight away when a packet arrives too late to play.
+/// Lost packets are concealed by repeating the previous one at decreasing level; longer gaps end the talkspurt and the
+/// next packet starts a new timeline. Only used from a single task.
+class RtpJitterBuffer {
+ public:
+  static constexpr size_t SLOTS = 16;                // reorder window in packets; a power of two
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1460;   // fits an Ethernet MTU after the IP, UDP and RTP headers
+  static constexpr uint32_t MAX_CONCEALED_PACKETS = 3;
+
+  /// @brief Allocates the packet slots and sets the stream format. Not real-time safe.
+  /// @param bytes_per_sample 2 for L16 or 3 for L24
+  /// @return False if the allocation failed or the format is unsupported
+  bool configure(uint32_t sample_rate, uint8_t channels, uint8_t bytes_per_sample, uint32_t min_delay_ms,
+                 uint32_t max_delay_ms);
+
+  /// @brief Drops all buffered packets and forgets the stream, keeping the jitter estimate.
+  void reset();
+
+  /// @brief Stores a packet, converting its big-endian samples to little-endian.
+  /// @return False if the packet was dropped: malformed, a duplicate, or too late to play
+  bool insert(const RtpPacket &packet, int64_t arrival_us);
+
+  /// @brief Releases the next block once its packet has arrived, or a concealment block once its presentation time
+  /// has been reached without it. The data stays valid until the next call.
+  /// @return False if nothing is ready
+  bool pop(int64_t now_us, PlayoutBlock &block);
+
+  /// @brief Moves the timeline so the next buffered packet is due at `now_us`. Used when the output was not ready
+  /// while the first packets arrived.
+  void rebase(int64_t now_us);
+
+  bool is_active() const { return this->started_ && !this->waiting_; }
+  uint32_t get_jitter_us() const { return this->jitter_us_; }
+  uint32_t get_target_delay_us() const { return this->target_delay_us_; }
+  uint32_t get_received_packets() const { return this->received_packets_; }
+  uint32_t get_lost_packets() const { return this->lost_packets_; }
+  uint32_t get_late_packets() const { return this->late_packets_; }
+
+ protected:
+  struct Slot {
+    int64_t arrival_us{0};
+    uint32_t timestamp{0};
+    uint16_t sequence{0};
+    uint16_t bytes{0};
+    bool filled{false};
+  };
+
+  /// @brief Starts a new timeline at `packet`, with the playout delay recomputed from the jitter estimate.
+  void start_(const RtpPacket &packet, int64_t arrival_us);
+
+  /// @brief Time at which the frame with RTP timestamp `timestamp` is expected to arrive.
+  int64_t expected_us_(uint32_t timestamp) const {
+    const int64_t frames = static_cast<int32_t>(timestamp - this->anchor_timestamp_);
+    return this->anchor_us_ + frames * 1000000 / this->sample_rate_;
+  }
+
+  uint32_t packet_duration_us_() const {
+    return static_cast<uint32_t>(static_cast<uint64_t>(this->frames_per_packet_) * 1000000 / this->sample_rate_);
+  }
+
+  std::unique_ptr<uint8_t[]> storage_;       // SLOTS payloads of MAX_PAYLOAD_SIZE bytes
+  std::unique_ptr<uint8_t[]> last_payload_;  // copy of the last released block, repeated to conceal losses
+  Slot slots_[SLOTS];
+  size_t last_payload_bytes_{0};
+
+  uint32_t sample_rate_{48000};
+  uint32_t min_delay_us_{0};
+  uint32_t max_delay_us_{0};
+  uint8_t bytes_per_sample_{2};
+  uint8_t bytes_per_frame_{2};
+
+  // Timeline: the frame with anchor_timestamp_ is expected to arrive at anchor_us_
+  int64_t anchor_us_{0};
+  uint32_t anchor_timestamp_{0};
+  uint32_t next_timestamp_{0};
+  uint32_t ssrc_{0};
+  uint32_t frames_per_packet_{0};
+  uint16_t next_sequence_{0};
+  bool started_{false};
+  bool waiting_{false};  // the talkspurt ended; the next packet starts a new timeline
+  uint32_t concealed_in_row_{0};
+
+  int32_t last_transit_us_{0};
+  int32_t drift_us_{0};  // smoothed transit time relative to the anchor, tracking sender clock drift
+  uint32_t jitter_us_{0};
+  uint32_t target_delay_us_{0};
+
+  uint32_t received_packets_{0};
+  uint32_t lost_packets_{0};
+  uint32_t late_packets_{0};
+};
+
+}  // namespace esphome::rtp_audio
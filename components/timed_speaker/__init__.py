@@ -0,0 +1,9 @@
+# Timed speaker component - shared interface for speakers that can report playback timing
+# Header-only; auto-loaded by speaker platforms that implement or forward the interface
+import esphome.codegen as cg
+import esphome.config_validation as cv
+
+timed_speaker_ns = cg.esphome_ns.namespace("timed_speaker")
+TimedSpeaker = timed_speaker_ns.class_("TimedSpeaker")
+
+CONFIG_SCHEMA = cv.All(cv.Schema({}))
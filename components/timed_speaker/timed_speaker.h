@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome::timed_speaker {
+
+/// @brief Interface for speakers that can report when audio passed to play() will actually be heard.
+/// Implemented by the I2S speaker from its DMA completion timestamps, and by virtual speakers that forward to a timed
+/// output speaker with their own buffering added. All times are esp_timer microseconds.
+class TimedSpeaker {
+ public:
+  /// @brief How long audio written to play() right now will wait before its first frame reaches the DAC. Covers every
+  /// buffer between play() and the DAC: ring buffers, staging buffers and queued DMA descriptors.
+  virtual uint32_t get_output_latency_us() const = 0;
+
+  /// @brief Expected esp_timer time at which the next frame written via play() reaches the DAC.
+  virtual int64_t get_next_presentation_time_us() const = 0;
+
+  /// @brief Plays audio so its first frame reaches the DAC at `presentation_time_us`. The speaker pads the gap with
+  /// silence if the time is still ahead, or trims the start of the audio if it has already passed. Continue a clip that
+  /// did not fit with play(); it follows the scheduled part seamlessly.
+  /// @param presentation_time_us esp_timer time for the first frame of `data`
+  /// @return Number of bytes accepted; 0 if the speaker is not running yet, in which case the call should be retried
+  virtual size_t play_at(const uint8_t *data, size_t length, int64_t presentation_time_us) = 0;
+};
+
+}  // namespace esphome::timed_speaker
@@ -0,0 +1,149 @@
+// Feeds tones through BandEnergyAnalyzer block by block, as the speaker task does with each DMA buffer, and checks
+// that the band holding the tone lights up from the first block, stands clear of the others, and falls dark again
+// within a few blocks once the tone stops. Also checks the rise and fall the LED effect applies on top.
+
+#include "esphome/components/i2s_audio/speaker/band_energy.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using esphome::audio::AudioStreamInfo;
+using esphome::i2s_audio::BandEnergyAnalyzer;
+using esphome::i2s_audio::BandEnergySnapshot;
+using esphome::i2s_audio::follow_band_levels;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr size_t BLOCK_FRAMES = 720;  // one 15 ms DMA buffer
+constexpr int64_t BLOCK_US = 15000;
+constexpr double PI = 3.14159265358979323846;
+const AudioStreamInfo STREAM_INFO(16, 2, SAMPLE_RATE);
+
+// Centres of the analyzer's bands: log-spaced from 80 Hz up to 0.4 of its 12 kHz analysis rate
+double band_centre(size_t band) {
+  return 80.0 * std::pow(4800.0 / 80.0, static_cast<double>(band) / (BandEnergySnapshot::NUM_BANDS - 1));
+}
+
+class ToneFeeder {
+ public:
+  /// Analyzes one block of a stereo tone (silence if `frequency` is 0) and returns the snapshot published for it
+  BandEnergySnapshot block(double frequency, double amplitude) {
+    std::vector<int16_t> samples(BLOCK_FRAMES * 2);
+    for (size_t i = 0; i < BLOCK_FRAMES; ++i) {
+      const double phase = 2.0 * PI * frequency * static_cast<double>(this->frame_ + i) / SAMPLE_RATE;
+      const auto sample = static_cast<int16_t>(std::lround(amplitude * 32767.0 * std::sin(phase)));
+      samples[2 * i] = sample;
+      samples[2 * i + 1] = sample;
+    }
+    this->frame_ += BLOCK_FRAMES;
+    const int64_t presentation_us = this->presentation_us_;
+    this->presentation_us_ += BLOCK_US;
+    this->analyzer_.analyze(reinterpret_cast<const uint8_t *>(samples.data()), samples.size() * sizeof(int16_t),
+                            presentation_us, STREAM_INFO);
+
+    BandEnergySnapshot snapshot;
+    if (!this->analyzer_.read(presentation_us, snapshot) || (snapshot.presentation_us != presentation_us)) {
+      std::printf("block at %lld was not published\n", static_cast<long long>(presentation_us));
+    }
+    return snapshot;
+  }
+
+ protected:
+  BandEnergyAnalyzer analyzer_;
+  uint64_t frame_{0};
+  int64_t presentation_us_{1000000};
+};
+
+void print(const char *label, const BandEnergySnapshot &snapshot) {
+  std::printf("  %-14s", label);
+  for (uint8_t level : snapshot.levels) {
+    std::printf(" %3u", level);
+  }
+  std::printf("\n");
+}
+
+bool tone_in_band(size_t band) {
+  const double frequency = band_centre(band);
+  std::printf("%.0f Hz at -6 dBFS (band %zu):\n", frequency, band);
+  ToneFeeder feeder;
+  bool ok = true;
+
+  // Rises at once: the very first block already shows the tone's band as the loudest
+  const BandEnergySnapshot first = feeder.block(frequency, 0.5);
+  print("first block", first);
+  BandEnergySnapshot steady;
+  for (int n = 0; n < 10; ++n) {
+    steady = feeder.block(frequency, 0.5);
+  }
+  print("steady", steady);
+  for (size_t other = 0; other < BandEnergySnapshot::NUM_BANDS; ++other) {
+    if (other == band) {
+      continue;
+    }
+    ok &= (first.levels[band] > first.levels[other]);
+    // Two bands away the tone is well down the band-pass skirts
+    const size_t distance = (other > band) ? other - band : band - other;
+    ok &= (steady.levels[band] >= steady.levels[other] + ((distance >= 2) ? 40 : 10));
+  }
+  // A -6 dBFS sine has a mean square 9 dB below full scale, which the 60 dB range puts at about 217
+  ok &= (steady.levels[band] >= 200) && (steady.levels[band] <= 230);
+
+  // Decays: once the tone stops, the band falls block by block as the filter's ringing dies out, and every band is
+  // dark within 60 ms. The abrupt stop splatters across the other bands for a block, so only the tone's band is
+  // required to fall steadily.
+  uint8_t previous = steady.levels[band];
+  for (int n = 1; n <= 4; ++n) {
+    const BandEnergySnapshot after = feeder.block(0.0, 0.0);
+    char label[16];
+    std::snprintf(label, sizeof(label), "silence %d", n);
+    print(label, after);
+    ok &= (after.levels[band] < previous) || (after.levels[band] == 0);
+    previous = after.levels[band];
+    if (n == 4) {
+      for (uint8_t level : after.levels) {
+        ok &= (level == 0);
+      }
+    }
+  }
+
+  // The LED effect shows the same thing with a slower fall: with the default 300 ms decay and 16 ms updates, the
+  // band jumps to the tone at once and then takes 300 ms times its level to go dark
+  float levels[BandEnergySnapshot::NUM_BANDS] = {};
+  constexpr float FALL = 16.0f / 300.0f;
+  follow_band_levels(levels, &first, FALL);
+  ok &= (levels[band] == first.levels[band] / 255.0f);
+  follow_band_levels(levels, &steady, FALL);
+  const float held = levels[band];
+  int updates = 0;
+  while ((levels[band] > 0.0f) && (updates < 100)) {
+    follow_band_levels(levels, nullptr, FALL);
+    ++updates;
+  }
+  std::printf("  effect: %.2f fades in %d updates\n", held, updates);
+  ok &= (updates == static_cast<int>(std::ceil(held / FALL)));
+
+  // A quieter tone lands lower in proportion: 20 dB down is a third of the 60 dB range
+  BandEnergySnapshot quiet;
+  for (int n = 0; n < 10; ++n) {
+    quiet = feeder.block(frequency, 0.05);
+  }
+  print("-26 dBFS", quiet);
+  ok &= std::abs(static_cast<int>(steady.levels[band]) - static_cast<int>(quiet.levels[band]) - 85) <= 5;
+
+  std::printf("  %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  for (size_t band = 0; band < BandEnergySnapshot::NUM_BANDS; ++band) {
+    ok &= tone_in_band(band);
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+// Exercises EchoReferenceRing at the places its layout gets awkward: a block that would run past the end of the
+// storage, leaving room for a wrap marker or too little for a header; a subscriber reading a block in pieces; and
+// blocks dropped whole when the ring is full.
+
+#include "esphome/components/i2s_audio/speaker/echo_reference.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using esphome::audio::AudioStreamInfo;
+using esphome::i2s_audio::EchoReferenceRing;
+
+namespace {
+
+// 16-bit stereo, 4 bytes per frame. Every block carries a 24-byte header and is padded to 8 bytes, and the ring is
+// exactly 256 bytes, so the positions below are known.
+const AudioStreamInfo STREAM_INFO(16, 2, 48000);
+constexpr size_t CAPACITY = 256;
+
+std::vector<uint8_t> block(size_t bytes, uint8_t seed) {
+  std::vector<uint8_t> data(bytes);
+  for (size_t i = 0; i < bytes; ++i) {
+    data[i] = static_cast<uint8_t>(seed + i);
+  }
+  return data;
+}
+
+void write(EchoReferenceRing &ring, const std::vector<uint8_t> &data, int64_t presentation_us) {
+  ring.write(data.data(), data.size(), presentation_us, STREAM_INFO);
+}
+
+/// Reads `max_bytes` and compares the result with `expected[offset...]` and its presentation time
+bool expect_read(const char *step, EchoReferenceRing &ring, size_t max_bytes, const std::vector<uint8_t> &expected,
+                 size_t offset, size_t expected_bytes, int64_t expected_us) {
+  std::vector<uint8_t> out(max_bytes);
+  int64_t presentation_us = -1;
+  const size_t bytes = ring.read(out.data(), max_bytes, presentation_us);
+  bool ok = (bytes == expected_bytes);
+  for (size_t i = 0; ok && (i < bytes); ++i) {
+    ok = (out[i] == expected[offset + i]);
+  }
+  if (ok && (bytes > 0)) {
+    ok = (presentation_us == expected_us);
+  }
+  if (!ok) {
+    std::printf("%s: read %zu bytes at %lld, expected %zu bytes at %lld\n", step, bytes,
+                static_cast<long long>(presentation_us), expected_bytes, static_cast<long long>(expected_us));
+  }
+  return ok;
+}
+
+bool partial_reads() {
+  auto ring = EchoReferenceRing::create(CAPACITY);
+  const auto data = block(40, 1);  // 10 frames
+  write(*ring, data, 1000);
+
+  bool ok = true;
+  ok &= expect_read("first piece", *ring, 16, data, 0, 16, 1000);
+  // Only whole frames are returned, and the time moves on by the frames already taken
+  ok &= expect_read("uneven piece", *ring, 7, data, 16, 4, 1000 + STREAM_INFO.frames_to_microseconds(4));
+  ok &= expect_read("rest of block", *ring, 64, data, 20, 20, 1000 + STREAM_INFO.frames_to_microseconds(5));
+  ok &= expect_read("empty", *ring, 64, data, 0, 0, 0);
+
+  // The next block starts over at its own time, even though the last one was read in pieces
+  const auto next = block(40, 100);
+  write(*ring, next, 5000);
+  ok &= expect_read("next block", *ring, 64, next, 0, 40, 5000);
+  ok &= (ring->take_dropped_blocks() == 0);
+  std::printf("partial reads: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+bool wrap_marker() {
+  auto ring = EchoReferenceRing::create(CAPACITY);
+  bool ok = true;
+  // Three 64-byte blocks move the write position to 192
+  for (int n = 0; n < 3; ++n) {
+    const auto data = block(40, static_cast<uint8_t>(n));
+    write(*ring, data, n * 1000);
+    ok &= expect_read("filler", *ring, 64, data, 0, 40, n * 1000);
+  }
+  // A 96-byte block doesn't fit in the 64 bytes left, which hold a wrap marker; it lands at the start instead
+  const auto wrapped = block(72, 200);
+  write(*ring, wrapped, 9000);
+  ok &= expect_read("wrapped block, first piece", *ring, 32, wrapped, 0, 32, 9000);
+  ok &= expect_read("wrapped block, rest", *ring, 128, wrapped, 32, 40, 9000 + STREAM_INFO.frames_to_microseconds(8));
+  ok &= expect_read("empty after wrap", *ring, 64, wrapped, 0, 0, 0);
+  ok &= (ring->take_dropped_blocks() == 0);
+  std::printf("wrap marker: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+bool short_tail() {
+  auto ring = EchoReferenceRing::create(CAPACITY);
+  bool ok = true;
+  // A 240-byte block leaves 16 bytes at the end, too few for a header, so no marker is written there
+  const auto large = block(216, 7);
+  write(*ring, large, 0);
+  ok &= expect_read("large block", *ring, 256, large, 0, 216, 0);
+  const auto wrapped = block(40, 50);
+  write(*ring, wrapped, 2000);
+  ok &= expect_read("block after short tail", *ring, 64, wrapped, 0, 40, 2000);
+  ok &= expect_read("empty after short tail", *ring, 64, wrapped, 0, 0, 0);
+  ok &= (ring->take_dropped_blocks() == 0);
+  std::printf("short tail: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+bool dropped_blocks() {
+  auto ring = EchoReferenceRing::create(CAPACITY);
+  bool ok = true;
+  std::vector<std::vector<uint8_t>> blocks;
+  for (int n = 0; n < 4; ++n) {
+    blocks.push_back(block(40, static_cast<uint8_t>(10 * n)));
+    write(*ring, blocks.back(), n * 1000);
+  }
+  // Full: the block is dropped whole, and counted once
+  write(*ring, block(8, 0), 4000);
+  ok &= (ring->take_dropped_blocks() == 1);
+  ok &= (ring->take_dropped_blocks() == 0);
+
+  // A partly read block still holds its space
+  ok &= expect_read("oldest, first piece", *ring, 8, blocks[0], 0, 8, 0);
+  write(*ring, block(8, 0), 4000);
+  ok &= (ring->take_dropped_blocks() == 1);
+
+  ok &= expect_read("oldest, rest", *ring, 64, blocks[0], 8, 32, STREAM_INFO.frames_to_microseconds(2));
+
+  // Three blocks written and one released leave 128 bytes free, but a 96-byte block would first have to skip the 64
+  // bytes left before the end, so it is dropped too
+  ring = EchoReferenceRing::create(CAPACITY);
+  for (int n = 0; n < 3; ++n) {
+    write(*ring, blocks[n], n * 1000);
+  }
+  ok &= expect_read("first of three", *ring, 64, blocks[0], 0, 40, 0);
+  write(*ring, block(72, 0), 4000);
+  ok &= (ring->take_dropped_blocks() == 1);
+
+  // A block that fits in the room before the end is kept, and everything comes back in order
+  const auto kept = block(40, 123);
+  write(*ring, kept, 5000);
+  ok &= (ring->take_dropped_blocks() == 0);
+  ok &= expect_read("second of three", *ring, 64, blocks[1], 0, 40, 1000);
+  ok &= expect_read("third of three", *ring, 64, blocks[2], 0, 40, 2000);
+  ok &= expect_read("kept", *ring, 64, kept, 0, 40, 5000);
+  ok &= expect_read("empty after drops", *ring, 64, kept, 0, 0, 0);
+  std::printf("dropped blocks: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= partial_reads();
+  ok &= wrap_marker();
+  ok &= short_tail();
+  ok &= dropped_blocks();
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
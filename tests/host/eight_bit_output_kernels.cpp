@@ -0,0 +1,70 @@
+// Checks the generic output kernels on 8-bit audio. Stream samples are unsigned offset binary (0x80 is silence), while
+// the I2S slots they are written to are two's complement at every width.
+
+#include "esphome/components/i2s_audio/speaker/i2s_audio_speaker_kernels.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using esphome::i2s_audio::OutputKernel;
+using esphome::i2s_audio::OutputKernelParams;
+using esphome::i2s_audio::kernels::select_output_kernel;
+using esphome::i2s_audio::kernels::select_ramp_output_kernel;
+
+namespace {
+
+template<typename OutT>
+bool expect(const char *name, OutputKernel kernel, const std::vector<uint8_t> &in, const std::vector<OutT> &expected,
+            const OutputKernelParams &params) {
+  std::vector<OutT> out(in.size());
+  std::vector<uint8_t> bytes(in.size() * sizeof(OutT));
+  kernel(in.data(), bytes.data(), in.size(), params);
+  std::memcpy(out.data(), bytes.data(), bytes.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    if (out[i] != expected[i]) {
+      std::printf("%s: sample %zu (0x%02x) gave %lld, expected %lld\n", name, i, in[i], static_cast<long long>(out[i]),
+                  static_cast<long long>(expected[i]));
+      return false;
+    }
+  }
+  std::printf("%s: ok\n", name);
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<uint8_t> input = {0x80, 0x00, 0xFF, 0xC0, 0x40, 0x81};
+  OutputKernelParams unity;
+  OutputKernelParams half;
+  half.q31_gain = INT32_MAX / 2 + 1;
+  OutputKernelParams swapped;
+  swapped.swap_pairs = true;
+
+  bool ok = true;
+  ok &= expect<int16_t>("8 -> 16, unity", select_output_kernel(1, 2), input,
+                        {0, -32768, 32512, 16384, -16384, 256}, unity);
+  ok &= expect<int16_t>("8 -> 16, swap", select_output_kernel(1, 2), input,
+                        {-32768, 0, 16384, 32512, 256, -16384}, swapped);
+  ok &= expect<int32_t>("8 -> 32, half volume", select_output_kernel(1, 4), input,
+                        {0, -0x40000000, 0x3F800000, 0x20000000, -0x20000000, 0x00800000}, half);
+  ok &= expect<int16_t>("8 -> 16, ramp at half volume", select_ramp_output_kernel(1, 2), input,
+                        {0, -16384, 16256, 8192, -8192, 128}, half);
+
+  // Silence and the extremes land on the signed slot values, not on the offset-binary ones
+  ok &= expect<int8_t>("8 -> 8, unity", select_output_kernel(1, 1), input, {0, -128, 127, 64, -64, 1}, unity);
+  const std::vector<uint8_t> words = {0x00, 0x00, 0x00, 0x80, 0xFF, 0x7F};  // 0, -32768, 32767 as 16-bit
+  std::vector<int8_t> narrowed(3);
+  select_output_kernel(2, 1)(words.data(), reinterpret_cast<uint8_t *>(narrowed.data()), 3, unity);
+  if ((narrowed[0] != 0) || (narrowed[1] != -128) || (narrowed[2] != 127)) {
+    std::printf("16 -> 8: gave %d %d %d\n", narrowed[0], narrowed[1], narrowed[2]);
+    ok = false;
+  } else {
+    std::printf("16 -> 8: ok\n");
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+// Times the fused output kernels against the multi-pass path they replaced: software volume in place, then the ESP32
+// mono pair swap in place, then a separate 16 -> 32-bit expansion into the DMA buffer. Fails if the two disagree.
+
+#include "esphome/components/i2s_audio/speaker/i2s_audio_speaker_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using esphome::i2s_audio::OutputKernelParams;
+using esphome::i2s_audio::kernels::fused_output;
+
+namespace {
+
+// One DMA buffer of 16-bit stereo at 48 kHz, 15 ms
+constexpr size_t BLOCK_SAMPLES = 1440;
+constexpr int ITERATIONS = 20000;
+
+// The previous path, one pass per step as it ran in the speaker task
+template<typename InT> void apply_volume(InT *data, size_t samples, int32_t q31_gain) {
+  if (q31_gain == INT32_MAX) {
+    return;
+  }
+  for (size_t i = 0; i < samples; ++i) {
+    data[i] = static_cast<InT>((static_cast<int64_t>(data[i]) * q31_gain) >> 31);
+  }
+}
+
+template<typename InT> void swap_pairs(InT *data, size_t samples) {
+  for (size_t i = 0; i + 1 < samples; i += 2) {
+    const InT tmp = data[i];
+    data[i] = data[i + 1];
+    data[i + 1] = tmp;
+  }
+}
+
+template<typename InT, typename OutT, int Shift>
+void multi_pass(InT *data, OutT *out, size_t samples, const OutputKernelParams &params) {
+  apply_volume(data, samples, params.q31_gain);
+  if (params.swap_pairs) {
+    swap_pairs(data, samples);
+  }
+  if constexpr (Shift > 0) {
+    for (size_t i = 0; i < samples; ++i) {
+      out[i] = static_cast<OutT>(static_cast<int32_t>(data[i]) << Shift);
+    }
+  }
+}
+
+template<typename InT, typename OutT, int Shift> bool run(const char *name, int32_t q31_gain, bool swap) {
+  std::vector<InT> source(BLOCK_SAMPLES);
+  uint32_t seed = 12345;
+  for (auto &sample : source) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = static_cast<InT>(seed >> (32 - 8 * sizeof(InT)));
+  }
+  OutputKernelParams params;
+  params.q31_gain = q31_gain;
+  params.swap_pairs = swap;
+
+  // The multi-pass path works in place on the transfer buffer, so it gets a fresh copy every block
+  std::vector<InT> work(BLOCK_SAMPLES);
+  std::vector<OutT> multi_out(BLOCK_SAMPLES);
+  std::vector<OutT> fused_out(BLOCK_SAMPLES);
+  auto multi_result = [&]() -> const OutT * {
+    if constexpr (Shift > 0) {
+      return multi_out.data();
+    } else {
+      return reinterpret_cast<const OutT *>(work.data());
+    }
+  };
+
+  work = source;
+  multi_pass<InT, OutT, Shift>(work.data(), multi_out.data(), BLOCK_SAMPLES, params);
+  fused_output<InT, OutT, Shift>(source.data(), fused_out.data(), BLOCK_SAMPLES, params);
+  // The fused kernel rounds once at the output width, the old path at the input width
+  const int64_t tolerance = int64_t{1} << Shift;
+  for (size_t i = 0; i < BLOCK_SAMPLES; ++i) {
+    if (std::llabs(static_cast<int64_t>(multi_result()[i]) - fused_out[i]) >= tolerance) {
+      std::printf("%s: sample %zu differs: multi-pass %lld, fused %lld\n", name, i,
+                  static_cast<long long>(multi_result()[i]), static_cast<long long>(fused_out[i]));
+      return false;
+    }
+  }
+
+  using Clock = std::chrono::steady_clock;
+  int64_t checksum = 0;
+  auto start = Clock::now();
+  for (int n = 0; n < ITERATIONS; ++n) {
+    std::copy(source.begin(), source.end(), work.begin());
+    multi_pass<InT, OutT, Shift>(work.data(), multi_out.data(), BLOCK_SAMPLES, params);
+    checksum += multi_result()[n % BLOCK_SAMPLES];
+  }
+  const double multi_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  start = Clock::now();
+  for (int n = 0; n < ITERATIONS; ++n) {
+    fused_output<InT, OutT, Shift>(source.data(), fused_out.data(), BLOCK_SAMPLES, params);
+    checksum += fused_out[n % BLOCK_SAMPLES];
+  }
+  const double fused_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  const double samples = static_cast<double>(ITERATIONS) * BLOCK_SAMPLES;
+  std::printf("%-28s multi-pass %6.3f ns/sample  fused %6.3f ns/sample  speedup %.2fx  (checksum %lld)\n", name,
+              multi_ns / samples, fused_ns / samples, multi_ns / fused_ns, static_cast<long long>(checksum));
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  constexpr int32_t HALF = INT32_MAX / 2;
+  bool ok = true;
+  ok &= run<int16_t, int32_t, 16>("16 -> 32, volume", HALF, false);
+  ok &= run<int16_t, int32_t, 16>("16 -> 32, volume + swap", HALF, true);
+  ok &= run<int16_t, int32_t, 16>("16 -> 32, unity", INT32_MAX, false);
+  ok &= run<int16_t, int16_t, 0>("16 -> 16, volume + swap", HALF, true);
+  ok &= run<int32_t, int32_t, 0>("32 -> 32, volume", HALF, false);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,265 @@
+// Runs tones through the IntegerResampler for the conversions the resampler components route to it. Checks the
+// signal-to-noise ratio of passband tones, the gain across the passband, and how far an out-of-band tone is suppressed
+// when decimating, then times each conversion. Input arrives in odd-sized chunks and output room is kept small so the
+// block and decimation phase bookkeeping in process() is exercised too. A short burst checks that flush() pushes the
+// end of a stream out of the filter history.
+
+#include "esphome/components/resampler/integer_resampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using esphome::audio::AudioStreamInfo;
+using esphome::resampler::IntegerResampler;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double AMPLITUDE = 0.5;
+constexpr double MIN_SNR_DB = 70.0;
+constexpr double MAX_PASSBAND_ERROR_DB = 0.1;
+constexpr double MAX_ALIAS_DB = -70.0;
+constexpr double THROUGHPUT_SECONDS = 20.0;
+
+struct Conversion {
+  uint32_t input_rate;
+  uint32_t output_rate;
+  uint8_t input_bytes;
+  uint8_t output_bytes;
+  uint8_t channels;
+};
+
+// Samples are little-endian and left aligned, as on the I2S bus
+void store_sample(uint8_t *out, uint8_t bytes, double value) {
+  const int32_t q31 = static_cast<int32_t>(std::lround(std::clamp(value, -1.0, 1.0 - 1e-9) * 2147483648.0));
+  for (uint8_t b = 0; b < bytes; ++b) {
+    out[b] = static_cast<uint8_t>(static_cast<uint32_t>(q31) >> (32 - 8 * bytes + 8 * b));
+  }
+}
+
+double load_sample(const uint8_t *in, uint8_t bytes) {
+  uint32_t q31 = 0;
+  for (uint8_t b = 0; b < bytes; ++b) {
+    q31 |= static_cast<uint32_t>(in[b]) << (32 - 8 * bytes + 8 * b);
+  }
+  return static_cast<int32_t>(q31) / 2147483648.0;
+}
+
+/// Resamples `seconds` of a tone at `frequency` on every channel and returns the output, one vector per channel
+std::vector<std::vector<double>> resample_tone(const Conversion &conversion, double frequency, double seconds) {
+  const AudioStreamInfo input(conversion.input_bytes * 8, conversion.channels, conversion.input_rate);
+  const AudioStreamInfo output(conversion.output_bytes * 8, conversion.channels, conversion.output_rate);
+  auto resampler = std::make_unique<IntegerResampler>();
+  resampler->start(input, output);
+
+  const size_t input_frames = static_cast<size_t>(conversion.input_rate * seconds);
+  std::vector<uint8_t> source(input.frames_to_bytes(input_frames));
+  for (size_t i = 0; i < input_frames; ++i) {
+    for (uint8_t c = 0; c < conversion.channels; ++c) {
+      // Each channel gets its own phase so crossed channels would show up as noise
+      const double value = AMPLITUDE * std::sin(2.0 * PI * frequency * i / conversion.input_rate + c);
+      store_sample(&source[input.frames_to_bytes(i) + input.samples_to_bytes(c)], conversion.input_bytes, value);
+    }
+  }
+
+  std::vector<uint8_t> sink(output.frames_to_bytes(input_frames * 3 + 64));
+  static constexpr size_t CHUNKS[] = {1, 13, 50, 7, 64, 33};
+  size_t consumed = 0;
+  size_t produced = 0;
+  for (size_t n = 0; consumed < input_frames; ++n) {
+    size_t in_frames = std::min(CHUNKS[n % std::size(CHUNKS)], input_frames - consumed);
+    size_t out_frames = 7;
+    resampler->process(&source[input.frames_to_bytes(consumed)], in_frames, &sink[output.frames_to_bytes(produced)],
+                       out_frames);
+    consumed += in_frames;
+    produced += out_frames;
+  }
+
+  std::vector<std::vector<double>> channels(conversion.channels, std::vector<double>(produced));
+  for (size_t i = 0; i < produced; ++i) {
+    for (uint8_t c = 0; c < conversion.channels; ++c) {
+      const uint8_t *sample = &sink[output.frames_to_bytes(i) + output.samples_to_bytes(c)];
+      channels[c][i] = load_sample(sample, conversion.output_bytes);
+    }
+  }
+  return channels;
+}
+
+struct ToneFit {
+  double amplitude;
+  double snr_db;
+};
+
+/// Least-squares fit of a tone at `frequency` to the settled part of `samples`; the residual is noise and distortion
+ToneFit fit_tone(const std::vector<double> &samples, size_t skip, double frequency, uint32_t rate) {
+  const double w = 2.0 * PI * frequency / rate;
+  double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+  for (size_t i = skip; i < samples.size(); ++i) {
+    const double s = std::sin(w * i), c = std::cos(w * i);
+    ss += s * s;
+    sc += s * c;
+    cc += c * c;
+    ys += samples[i] * s;
+    yc += samples[i] * c;
+  }
+  const double det = ss * cc - sc * sc;
+  const double a = (ys * cc - yc * sc) / det;
+  const double b = (yc * ss - ys * sc) / det;
+
+  double signal = 0.0, noise = 0.0;
+  for (size_t i = skip; i < samples.size(); ++i) {
+    const double fitted = a * std::sin(w * i) + b * std::cos(w * i);
+    signal += fitted * fitted;
+    noise += (samples[i] - fitted) * (samples[i] - fitted);
+  }
+  return {std::sqrt(a * a + b * b), 10.0 * std::log10(signal / std::max(noise, 1e-30))};
+}
+
+bool check_tone(const Conversion &conversion, double frequency) {
+  const AudioStreamInfo input(conversion.input_bytes * 8, conversion.channels, conversion.input_rate);
+  const AudioStreamInfo output(conversion.output_bytes * 8, conversion.channels, conversion.output_rate);
+  const size_t skip = IntegerResampler::latency_frames(input, output) + 2 * IntegerResampler::TAPS_PER_PHASE;
+
+  const auto channels = resample_tone(conversion, frequency, 0.5);
+  bool ok = true;
+  double worst_snr_db = 1e9, worst_gain_db = 0.0;
+  for (const auto &samples : channels) {
+    const ToneFit fit = fit_tone(samples, skip, frequency, conversion.output_rate);
+    const double gain_db = 20.0 * std::log10(fit.amplitude / AMPLITUDE);
+    worst_snr_db = std::min(worst_snr_db, fit.snr_db);
+    if (std::fabs(gain_db) > std::fabs(worst_gain_db)) {
+      worst_gain_db = gain_db;
+    }
+    ok &= fit.snr_db >= MIN_SNR_DB && std::fabs(gain_db) <= MAX_PASSBAND_ERROR_DB;
+  }
+  std::printf("%5u -> %5u Hz, %u -> %u bytes, %u ch, %5.0f Hz tone: SNR %5.1f dB, gain %+.3f dB%s\n",
+              conversion.input_rate, conversion.output_rate, conversion.input_bytes, conversion.output_bytes,
+              conversion.channels, frequency, worst_snr_db, worst_gain_db, ok ? "" : "  FAILED");
+  return ok;
+}
+
+/// A tone above the output Nyquist frequency must not fold back into the decimated signal
+bool check_alias(const Conversion &conversion, double frequency) {
+  const AudioStreamInfo input(conversion.input_bytes * 8, conversion.channels, conversion.input_rate);
+  const AudioStreamInfo output(conversion.output_bytes * 8, conversion.channels, conversion.output_rate);
+  const size_t skip = IntegerResampler::latency_frames(input, output) + 2 * IntegerResampler::TAPS_PER_PHASE;
+
+  const auto channels = resample_tone(conversion, frequency, 0.5);
+  double peak = 0.0;
+  for (const auto &samples : channels) {
+    for (size_t i = skip; i < samples.size(); ++i) {
+      peak = std::max(peak, std::fabs(samples[i]));
+    }
+  }
+  const double alias_db = 20.0 * std::log10(peak / AMPLITUDE + 1e-12);
+  const bool ok = alias_db <= MAX_ALIAS_DB;
+  std::printf("%5u -> %5u Hz, %5.0f Hz tone above Nyquist: alias peak %.1f dB%s\n", conversion.input_rate,
+              conversion.output_rate, frequency, alias_db, ok ? "" : "  FAILED");
+  return ok;
+}
+
+/// A short burst of DC must come out whole once flush() has pushed the end of it out of the filter history, so the
+/// output sums to the input scaled by the rate ratio
+bool check_flush(const Conversion &conversion) {
+  const AudioStreamInfo input(conversion.input_bytes * 8, conversion.channels, conversion.input_rate);
+  const AudioStreamInfo output(conversion.output_bytes * 8, conversion.channels, conversion.output_rate);
+  auto resampler = std::make_unique<IntegerResampler>();
+  resampler->start(input, output);
+
+  const size_t input_frames = 240;
+  std::vector<uint8_t> source(input.frames_to_bytes(input_frames));
+  for (size_t i = 0; i < input_frames * conversion.channels; ++i) {
+    store_sample(&source[input.samples_to_bytes(i)], conversion.input_bytes, AMPLITUDE);
+  }
+
+  std::vector<uint8_t> sink(output.frames_to_bytes(input_frames * 3 + 64));
+  size_t produced = 0;
+  size_t in_frames = input_frames;
+  size_t out_frames = sink.size() / output.frames_to_bytes(1);
+  resampler->process(source.data(), in_frames, sink.data(), out_frames);
+  produced += out_frames;
+  // Small output room so the tail takes several calls
+  for (size_t calls = 0; resampler->has_tail() && calls < 100; ++calls) {
+    out_frames = 7;
+    resampler->flush(&sink[output.frames_to_bytes(produced)], out_frames);
+    produced += out_frames;
+  }
+
+  double sum = 0.0;
+  for (size_t i = 0; i < produced * conversion.channels; ++i) {
+    sum += load_sample(&sink[output.samples_to_bytes(i)], conversion.output_bytes);
+  }
+  const double expected = AMPLITUDE * conversion.channels * input_frames * conversion.output_rate /
+                          static_cast<double>(conversion.input_rate);
+  const double error = std::fabs(sum / expected - 1.0);
+  const bool ok = !resampler->has_tail() && in_frames == input_frames && error < 1e-3;
+  std::printf("%5u -> %5u Hz, %u ch: flushed burst holds %.5f of its input%s\n", conversion.input_rate,
+              conversion.output_rate, conversion.channels, sum / expected, ok ? "" : "  FAILED");
+  return ok;
+}
+
+/// Resamples in 10 ms blocks, the way the resampler tasks feed it, and reports the speed relative to real time
+void measure_throughput(const Conversion &conversion) {
+  const AudioStreamInfo input(conversion.input_bytes * 8, conversion.channels, conversion.input_rate);
+  const AudioStreamInfo output(conversion.output_bytes * 8, conversion.channels, conversion.output_rate);
+  auto resampler = std::make_unique<IntegerResampler>();
+  resampler->start(input, output);
+
+  const size_t block_frames = input.ms_to_frames(10);
+  std::vector<uint8_t> source(input.frames_to_bytes(block_frames));
+  for (size_t i = 0; i < source.size(); ++i) {
+    source[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  std::vector<uint8_t> sink(output.frames_to_bytes(output.ms_to_frames(10) + IntegerResampler::MAX_FACTOR));
+
+  const size_t blocks = static_cast<size_t>(THROUGHPUT_SECONDS * 100);
+  uint64_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t n = 0; n < blocks; ++n) {
+    size_t in_frames = block_frames;
+    size_t out_frames = output.ms_to_frames(10) + IntegerResampler::MAX_FACTOR;
+    resampler->process(source.data(), in_frames, sink.data(), out_frames);
+    checksum += sink[n % output.frames_to_bytes(out_frames)];
+  }
+  const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%5u -> %5u Hz, %u ch: %6.2f us per 10 ms block, %6.0fx real time  (checksum %llu)\n",
+              conversion.input_rate, conversion.output_rate, conversion.channels, elapsed_s * 1e6 / blocks,
+              THROUGHPUT_SECONDS / elapsed_s, static_cast<unsigned long long>(checksum));
+}
+
+}  // namespace
+
+int main() {
+  const Conversion up_3x{16000, 48000, 2, 4, 1};
+  const Conversion down_3x{48000, 16000, 4, 4, 2};
+  const Conversion down_3x_16bit{48000, 16000, 2, 2, 1};
+  const Conversion up_2x_24bit{16000, 32000, 3, 3, 2};
+  const Conversion down_2x{48000, 24000, 4, 4, 4};
+
+  bool ok = true;
+  for (double frequency : {100.0, 1000.0, 3000.0, 6000.0}) {
+    ok &= check_tone(up_3x, frequency);
+    ok &= check_tone(down_3x, frequency);
+    ok &= check_tone(up_2x_24bit, frequency);
+  }
+  ok &= check_tone(down_3x_16bit, 1000.0);
+  ok &= check_tone(down_2x, 5000.0);
+  ok &= check_alias(down_3x, 10000.0);
+  ok &= check_alias(down_3x, 14000.0);
+  ok &= check_alias(down_2x, 14000.0);
+  ok &= check_alias(down_2x, 18000.0);
+  for (const Conversion &conversion : {up_3x, down_3x, up_2x_24bit, down_2x}) {
+    ok &= check_flush(conversion);
+  }
+
+  for (const Conversion &conversion : {up_3x, down_3x, up_2x_24bit, down_2x}) {
+    measure_throughput(conversion);
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
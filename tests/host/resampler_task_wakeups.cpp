@@ -0,0 +1,142 @@
+// Measures how often a resampler task's input loop wakes and how much CPU it uses, idle and while a producer streams
+// audio into its AudioRing in small chunks the way the I2S read task and play() do. Compares the whole-block wait the
+// resampler tasks use with the previous loop that waited up to 20 ms for any audio. Fails if the idle task wakes at
+// all, if a streaming task wakes much more than once per block, or if the tail of a stream is not delivered.
+
+#include "esphome/components/audio_ring/audio_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+using esphome::audio_ring::AudioRing;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr size_t FRAME_BYTES = 4;  // 16-bit stereo
+constexpr uint32_t BLOCK_MS = 10;  // the resampler speaker's INPUT_BLOCK_MS
+constexpr uint32_t POLL_MS = 20;   // the wait before the tasks switched to whole blocks
+constexpr uint32_t CHUNK_MS = 2;
+constexpr uint32_t IDLE_MS = 500;
+constexpr uint32_t STREAM_MS = 1000;
+// Frames the producer writes after its last whole block, so the stream ends part way into one
+constexpr size_t TAIL_FRAMES = 123;
+
+enum class Wait { WHOLE_BLOCK, POLL };
+
+struct Result {
+  uint32_t wakeups{0};
+  int64_t cpu_us{0};
+  size_t frames{0};
+};
+
+// Updated by the consumer after every pass so the main thread can read them at any time
+struct Counters {
+  std::atomic<uint32_t> wakeups{0};
+  std::atomic<int64_t> cpu_us{0};
+  std::atomic<size_t> frames{0};
+
+  Result snapshot() const { return {this->wakeups.load(), this->cpu_us.load(), this->frames.load()}; }
+};
+
+int64_t thread_cpu_us() {
+  timespec now{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+/// The input side of the resampler tasks: wait, then copy everything queued into a staging buffer
+void consume(AudioRing &ring, Wait wait, std::atomic<bool> &stop, Counters &counters) {
+  std::vector<uint8_t> staging(SAMPLE_RATE / 1000 * BLOCK_MS * 8 * FRAME_BYTES);
+  const size_t block_frames = SAMPLE_RATE / 1000 * BLOCK_MS;
+  const int64_t cpu_start_us = thread_cpu_us();
+  while (!stop.load()) {
+    if (wait == Wait::WHOLE_BLOCK) {
+      ring.wait_for_block(block_frames, pdMS_TO_TICKS(BLOCK_MS), portMAX_DELAY);
+    } else {
+      ring.wait_for_available(1, pdMS_TO_TICKS(POLL_MS));
+    }
+    if (stop.load()) {
+      break;
+    }
+    ++counters.wakeups;
+    size_t run_frames = 0;
+    const uint8_t *run = ring.acquire_read(run_frames);
+    while (run_frames > 0) {
+      const size_t frames = std::min(run_frames, staging.size() / FRAME_BYTES);
+      std::memcpy(staging.data(), run, frames * FRAME_BYTES);
+      ring.commit_read(frames);
+      counters.frames += frames;
+      run = ring.acquire_read(run_frames);
+    }
+    counters.cpu_us = thread_cpu_us() - cpu_start_us;
+  }
+}
+
+/// Leaves the consumer idle for IDLE_MS, then streams for STREAM_MS and ends with a partial block
+void run(Wait wait, Result &idle, Result &streaming, size_t &produced_frames) {
+  auto ring = AudioRing::create(SAMPLE_RATE / 1000 * 100 * FRAME_BYTES, FRAME_BYTES);
+  std::atomic<bool> stop{false};
+  Counters counters;
+  std::thread consumer(consume, std::ref(*ring), wait, std::ref(stop), std::ref(counters));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_MS));
+  idle = counters.snapshot();
+
+  const size_t chunk_frames = SAMPLE_RATE / 1000 * CHUNK_MS;
+  std::vector<uint8_t> chunk(chunk_frames * FRAME_BYTES, 0x5A);
+  produced_frames = 0;
+  auto next = std::chrono::steady_clock::now();
+  for (uint32_t elapsed_ms = 0; elapsed_ms < STREAM_MS; elapsed_ms += CHUNK_MS) {
+    produced_frames += ring->write(chunk.data(), chunk.size(), 0) / FRAME_BYTES;
+    next += std::chrono::milliseconds(CHUNK_MS);
+    std::this_thread::sleep_until(next);
+  }
+  produced_frames += ring->write(chunk.data(), TAIL_FRAMES * FRAME_BYTES, 0) / FRAME_BYTES;
+
+  // Long enough for the tail's partial block timeout
+  std::this_thread::sleep_for(std::chrono::milliseconds(3 * BLOCK_MS));
+  stop.store(true);
+  ring->wake_consumer();
+  consumer.join();
+
+  const Result total = counters.snapshot();
+  streaming = {total.wakeups - idle.wakeups, total.cpu_us - idle.cpu_us, total.frames - idle.frames};
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  const uint32_t blocks = STREAM_MS / BLOCK_MS;
+
+  for (Wait wait : {Wait::POLL, Wait::WHOLE_BLOCK}) {
+    const char *name = (wait == Wait::WHOLE_BLOCK) ? "whole-block wait" : "20 ms polling";
+    Result idle, streaming;
+    size_t produced = 0;
+    run(wait, idle, streaming, produced);
+    std::printf("%-16s idle: %3u wakeups, %5lld us CPU in %u ms\n", name, idle.wakeups,
+                static_cast<long long>(idle.cpu_us), IDLE_MS);
+    std::printf("%-16s streaming: %3u wakeups for %u blocks, %5lld us CPU in %u ms, %zu of %zu frames\n", name,
+                streaming.wakeups, blocks, static_cast<long long>(streaming.cpu_us), STREAM_MS, streaming.frames,
+                produced);
+    if (wait == Wait::WHOLE_BLOCK) {
+      ok &= idle.wakeups == 0;
+      // One per block, plus one for the tail and a little slack for producer timing jitter
+      ok &= streaming.wakeups <= blocks + blocks / 10 + 1;
+      ok &= streaming.frames == produced;
+    }
+  }
+  if (!ok) {
+    std::printf("FAILED\n");
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
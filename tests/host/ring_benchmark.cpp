@@ -0,0 +1,176 @@
+// Compares audio_ring::AudioRing with ring_buffer::RingBuffer, which it replaced on the audio hand-off paths. Measures
+// streaming throughput between two threads and the cost of single write and read calls, for the copying API both
+// share and for AudioRing's in-place acquire/commit API. Every run checks that the bytes arrive intact and in order.
+//
+// The RingBuffer here is the host stand-in from stubs/, which models the FreeRTOS ring buffer's lock per call; the
+// numbers compare the two designs on the host, not the firmware's absolute costs.
+
+#include "esphome/components/audio_ring/audio_ring.h"
+#include "esphome/components/ring_buffer/ring_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using esphome::audio_ring::AudioRing;
+using esphome::ring_buffer::RingBuffer;
+
+namespace {
+
+constexpr size_t FRAME_BYTES = 4;             // 16-bit stereo
+constexpr size_t RING_BYTES = 48 * 100 * 4;   // 100 ms at 48 kHz
+constexpr size_t STREAM_BYTES = 256u << 20;   // per throughput run
+constexpr int LATENCY_CALLS = 2000000;
+
+using Clock = std::chrono::steady_clock;
+
+uint8_t pattern(size_t offset) { return static_cast<uint8_t>(offset * 31 + (offset >> 11)); }
+
+/// Copying API of each ring, so one template drives both
+struct AudioRingCopy {
+  std::unique_ptr<AudioRing> ring = AudioRing::create(RING_BYTES, FRAME_BYTES);
+  size_t write(const uint8_t *data, size_t bytes) { return this->ring->write(data, bytes, portMAX_DELAY); }
+  size_t read(uint8_t *data, size_t bytes) { return this->ring->read(data, bytes, portMAX_DELAY); }
+};
+
+struct RingBufferCopy {
+  std::unique_ptr<RingBuffer> ring = RingBuffer::create(RING_BYTES);
+  size_t write(const uint8_t *data, size_t bytes) {
+    return this->ring->write_without_replacement(data, bytes, portMAX_DELAY);
+  }
+  size_t read(uint8_t *data, size_t bytes) { return this->ring->read(data, bytes, portMAX_DELAY); }
+};
+
+/// Streams STREAM_BYTES from a producer thread to this one in `chunk_bytes` calls
+template<typename Ring> bool throughput(const char *name, size_t chunk_bytes) {
+  Ring ring;
+  std::thread producer([&ring, chunk_bytes]() {
+    std::vector<uint8_t> chunk(chunk_bytes);
+    size_t sent = 0;
+    while (sent < STREAM_BYTES) {
+      const size_t bytes = std::min(chunk_bytes, STREAM_BYTES - sent);
+      for (size_t i = 0; i < bytes; ++i) {
+        chunk[i] = pattern(sent + i);
+      }
+      size_t written = 0;
+      while (written < bytes) {
+        written += ring.write(chunk.data() + written, bytes - written);
+      }
+      sent += bytes;
+    }
+  });
+
+  std::vector<uint8_t> chunk(chunk_bytes);
+  size_t received = 0;
+  bool intact = true;
+  const auto start = Clock::now();
+  while (received < STREAM_BYTES) {
+    const size_t bytes = ring.read(chunk.data(), std::min(chunk_bytes, STREAM_BYTES - received));
+    for (size_t i = 0; i < bytes; ++i) {
+      intact &= chunk[i] == pattern(received + i);
+    }
+    received += bytes;
+  }
+  const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  producer.join();
+
+  std::printf("%-28s %5zu-byte chunks: %7.0f MB/s%s\n", name, chunk_bytes, STREAM_BYTES / seconds / 1e6,
+              intact ? "" : "  CORRUPTED");
+  return intact;
+}
+
+/// Fills the ring with `chunk_bytes` calls and drains it again on one thread, timing each half as a batch so the calls
+/// themselves are measured without any waiting or per-call clock reads
+template<typename Ring, typename Write, typename Read>
+bool latency(const char *name, size_t chunk_bytes, Write write_chunk, Read read_chunk) {
+  Ring ring;
+  const size_t batch = RING_BYTES / chunk_bytes;
+  const int rounds = LATENCY_CALLS / static_cast<int>(batch);
+  bool intact = true;
+  double write_ns = 0.0, read_ns = 0.0;
+  for (int round = 0; round < rounds; ++round) {
+    const auto start = Clock::now();
+    for (size_t n = 0; n < batch; ++n) {
+      write_chunk(ring, chunk_bytes, static_cast<uint8_t>(round + n));
+    }
+    const auto middle = Clock::now();
+    for (size_t n = 0; n < batch; ++n) {
+      intact &= read_chunk(ring, chunk_bytes, static_cast<uint8_t>(round + n));
+    }
+    const auto end = Clock::now();
+    write_ns += std::chrono::duration<double, std::nano>(middle - start).count();
+    read_ns += std::chrono::duration<double, std::nano>(end - middle).count();
+  }
+  const double calls = static_cast<double>(rounds) * batch;
+  std::printf("%-28s %5zu-byte calls: write %6.1f ns, read %6.1f ns%s\n", name, chunk_bytes, write_ns / calls,
+              read_ns / calls, intact ? "" : "  CORRUPTED");
+  return intact;
+}
+
+/// Copying API: each chunk is filled with one value and checked at both ends on the way out
+template<typename Ring> bool copy_latency(const char *name, size_t chunk_bytes) {
+  std::vector<uint8_t> in(chunk_bytes), out(chunk_bytes);
+  return latency<Ring>(
+      name, chunk_bytes,
+      [&in](Ring &ring, size_t bytes, uint8_t value) {
+        std::memset(in.data(), value, bytes);
+        ring.write(in.data(), bytes);
+      },
+      [&out](Ring &ring, size_t bytes, uint8_t value) {
+        return (ring.read(out.data(), bytes) == bytes) && (out[0] == value) && (out[bytes - 1] == value);
+      });
+}
+
+/// AudioRing's in-place API as the speaker task uses it: produce into and consume from the ring's own storage
+bool in_place_latency(size_t chunk_bytes) {
+  const size_t chunk_frames = chunk_bytes / FRAME_BYTES;
+  return latency<AudioRingCopy>(
+      "AudioRing acquire/commit", chunk_bytes,
+      [chunk_frames](AudioRingCopy &ring, size_t, uint8_t value) {
+        for (size_t remaining = chunk_frames; remaining > 0;) {
+          size_t frames = 0;
+          uint8_t *run = ring.ring->acquire_write(frames);
+          frames = std::min(frames, remaining);
+          std::memset(run, value, frames * FRAME_BYTES);
+          ring.ring->commit_write(frames);
+          remaining -= frames;
+        }
+      },
+      [chunk_frames](AudioRingCopy &ring, size_t, uint8_t value) {
+        bool intact = true;
+        for (size_t remaining = chunk_frames; remaining > 0;) {
+          size_t frames = 0;
+          const uint8_t *run = ring.ring->acquire_read(frames);
+          frames = std::min(frames, remaining);
+          intact &= (frames > 0) && (run[0] == value) && (run[frames * FRAME_BYTES - 1] == value);
+          ring.ring->commit_read(frames);
+          remaining -= frames;
+        }
+        return intact;
+      });
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  // 2 ms and 10 ms of 48 kHz stereo, the sizes play() and the I2S read task hand over
+  for (size_t chunk_bytes : {size_t{384}, size_t{1920}}) {
+    ok &= throughput<RingBufferCopy>("RingBuffer", chunk_bytes);
+    ok &= throughput<AudioRingCopy>("AudioRing write/read", chunk_bytes);
+  }
+  for (size_t chunk_bytes : {size_t{64}, size_t{384}, size_t{1920}}) {
+    ok &= copy_latency<RingBufferCopy>("RingBuffer", chunk_bytes);
+    ok &= copy_latency<AudioRingCopy>("AudioRing write/read", chunk_bytes);
+    ok &= in_place_latency(chunk_bytes);
+  }
+  if (!ok) {
+    std::printf("FAILED\n");
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
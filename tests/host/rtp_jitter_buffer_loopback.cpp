@@ -0,0 +1,283 @@
+// Loopback test of the RTP parser and jitter buffer: a simulated sender builds real RTP datagrams, a simulated network
+// delays, reorders and drops them, and the receiver inserts them on arrival and pops blocks every millisecond the way
+// the rtp_audio task does. Covers reordering, loss concealment, the end of a talkspurt, and following a sender whose
+// clock drifts against ours.
+
+#include "esphome/components/rtp_audio/rtp_jitter_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+using esphome::rtp_audio::parse_rtp_packet;
+using esphome::rtp_audio::PlayoutBlock;
+using esphome::rtp_audio::RtpJitterBuffer;
+using esphome::rtp_audio::RtpPacket;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr uint32_t FRAMES_PER_PACKET = 240;  // 5 ms
+constexpr int64_t PACKET_US = 5000;
+constexpr uint16_t FIRST_SEQUENCE = 65500;  // wraps early in every run
+constexpr uint32_t FIRST_TIMESTAMP = 0xFFFF0000u;
+constexpr uint32_t MIN_DELAY_MS = 20;
+constexpr uint32_t MAX_DELAY_MS = 100;
+
+struct Datagram {
+  int64_t arrival_us;
+  std::vector<uint8_t> bytes;
+};
+
+struct Network {
+  double sender_ppm{0.0};       // sender clock offset from ours
+  int64_t base_delay_us{2000};
+  int64_t jitter_us{0};         // uniform extra delay in [0, jitter_us]
+  std::set<uint32_t> dropped;   // packet indices that never arrive
+  uint32_t seed{1};
+
+  int64_t random(int64_t range) {
+    this->seed = this->seed * 1664525u + 1013904223u;
+    return (range > 0) ? static_cast<int64_t>(this->seed >> 8) % (range + 1) : 0;
+  }
+};
+
+/// Left channel carries the stream frame index, right channel its negation, so every block identifies itself
+int16_t left_sample(uint32_t frame) { return static_cast<int16_t>(frame % 30000); }
+
+/// Builds the datagram for packet `index`, cycling through the optional RTP header fields the parser has to skip
+std::vector<uint8_t> build_packet(uint32_t index) {
+  const bool csrc = (index % 3) == 1;
+  const bool extension = (index % 5) == 2;
+  const uint8_t padding = ((index % 7) == 3) ? 4 : 0;
+
+  std::vector<uint8_t> out;
+  out.push_back(0x80 | (padding ? 0x20 : 0) | (extension ? 0x10 : 0) | (csrc ? 1 : 0));
+  out.push_back(10);  // L16 stereo
+  const uint16_t sequence = static_cast<uint16_t>(FIRST_SEQUENCE + index);
+  const uint32_t timestamp = FIRST_TIMESTAMP + index * FRAMES_PER_PACKET;
+  out.push_back(sequence >> 8);
+  out.push_back(sequence & 0xFF);
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out.push_back((timestamp >> shift) & 0xFF);
+  }
+  for (uint8_t b : {0x12, 0x34, 0x56, 0x78}) {  // SSRC
+    out.push_back(b);
+  }
+  if (csrc) {
+    out.insert(out.end(), {0xCA, 0xFE, 0xBA, 0xBE});
+  }
+  if (extension) {
+    out.insert(out.end(), {0xBE, 0xDE, 0x00, 0x01, 0x01, 0x02, 0x03, 0x04});
+  }
+  for (uint32_t frame = 0; frame < FRAMES_PER_PACKET; ++frame) {
+    const int16_t left = left_sample(index * FRAMES_PER_PACKET + frame);
+    for (int16_t sample : {left, static_cast<int16_t>(-left)}) {
+      out.push_back(static_cast<uint16_t>(sample) >> 8);  // big-endian on the wire
+      out.push_back(static_cast<uint16_t>(sample) & 0xFF);
+    }
+  }
+  for (uint8_t i = 0; i < padding; ++i) {
+    out.push_back((i + 1 == padding) ? padding : 0);
+  }
+  return out;
+}
+
+int16_t read_le16(const uint8_t *p) { return static_cast<int16_t>(p[0] | (p[1] << 8)); }
+
+struct Played {
+  PlayoutBlock block;
+  int16_t first_left;
+  int16_t first_right;
+  bool intact;  // every frame follows the first one
+};
+
+struct Result {
+  std::vector<Played> played;
+  uint32_t inactive_pops{0};  // ticks with the buffer between talkspurts
+  const RtpJitterBuffer *buffer;
+};
+
+/// Sends `packets` packets through `network` and plays them out
+Result run(RtpJitterBuffer &buffer, Network &network, uint32_t packets) {
+  std::vector<Datagram> datagrams;
+  for (uint32_t index = 0; index < packets; ++index) {
+    if (network.dropped.count(index)) {
+      continue;
+    }
+    const int64_t sent_us = static_cast<int64_t>(index * PACKET_US / (1.0 + network.sender_ppm * 1e-6));
+    datagrams.push_back({sent_us + network.base_delay_us + network.random(network.jitter_us), build_packet(index)});
+  }
+  std::stable_sort(datagrams.begin(), datagrams.end(),
+                   [](const Datagram &a, const Datagram &b) { return a.arrival_us < b.arrival_us; });
+
+  Result result;
+  result.buffer = &buffer;
+  size_t next = 0;
+  // Blocks whose packet has arrived are released straight away, so the run ends with the last arrival rather than
+  // concealing past the end of the stream
+  const int64_t end_us = datagrams.back().arrival_us + 1000;
+  for (int64_t now_us = 0; now_us < end_us; now_us += 1000) {
+    for (; (next < datagrams.size()) && (datagrams[next].arrival_us <= now_us); ++next) {
+      RtpPacket packet;
+      if (!parse_rtp_packet(datagrams[next].bytes.data(), datagrams[next].bytes.size(), packet)) {
+        std::printf("parse failed\n");
+        std::exit(EXIT_FAILURE);
+      }
+      buffer.insert(packet, datagrams[next].arrival_us);
+    }
+    if (!buffer.is_active()) {
+      ++result.inactive_pops;
+    }
+    PlayoutBlock block;
+    while (buffer.pop(now_us, block)) {
+      Played played{block, read_le16(block.data), read_le16(block.data + 2), true};
+      for (size_t i = 0; i + 3 < block.bytes; i += 4) {
+        const int16_t left = read_le16(block.data + i);
+        if (!block.concealed && ((left != left_sample(played.first_left + i / 4)) ||
+                                 (read_le16(block.data + i + 2) != -left))) {
+          played.intact = false;
+        }
+      }
+      result.played.push_back(played);
+    }
+  }
+  return result;
+}
+
+bool check(bool condition, const char *what) {
+  if (!condition) {
+    std::printf("  FAILED: %s\n", what);
+  }
+  return condition;
+}
+
+/// Packets delayed by up to 12 ms arrive out of order but all play, in order, within the playout delay
+bool test_reorder() {
+  RtpJitterBuffer buffer;
+  buffer.configure(SAMPLE_RATE, CHANNELS, 2, MIN_DELAY_MS, MAX_DELAY_MS);
+  Network network;
+  network.jitter_us = 12000;
+  constexpr uint32_t PACKETS = 4000;
+  const Result result = run(buffer, network, PACKETS);
+
+  bool in_order = true;
+  bool intact = true;
+  for (size_t i = 0; i < result.played.size(); ++i) {
+    in_order &= result.played[i].first_left == left_sample(i * FRAMES_PER_PACKET);
+    intact &= result.played[i].intact && !result.played[i].block.concealed;
+    if (i > 0) {
+      in_order &= result.played[i].block.presentation_us - result.played[i - 1].block.presentation_us == PACKET_US;
+    }
+  }
+  std::printf("reorder: played %zu of %u, jitter %u us, target delay %u us, late %u, lost %u\n",
+              result.played.size(), PACKETS, buffer.get_jitter_us(), buffer.get_target_delay_us(),
+              buffer.get_late_packets(), buffer.get_lost_packets());
+  bool ok = check(result.played.size() == PACKETS, "every packet plays");
+  ok &= check(in_order, "packets play in sequence on a continuous timeline");
+  ok &= check(intact, "payloads arrive intact and byte-swapped");
+  ok &= check(buffer.get_late_packets() == 0 && buffer.get_lost_packets() == 0, "nothing late or lost");
+  return ok;
+}
+
+/// A single loss is concealed by the previous block at half level; a burst longer than the concealment limit skips to
+/// the next buffered packet; a gap with nothing buffered ends the talkspurt and the next packet starts a new timeline
+bool test_concealment() {
+  RtpJitterBuffer buffer;
+  buffer.configure(SAMPLE_RATE, CHANNELS, 2, MIN_DELAY_MS, MAX_DELAY_MS);
+  Network network;
+  network.dropped.insert(100);
+  for (uint32_t index = 200; index <= 205; ++index) {
+    network.dropped.insert(index);
+  }
+  for (uint32_t index = 300; index < 340; ++index) {
+    network.dropped.insert(index);
+  }
+  constexpr uint32_t PACKETS = 400;
+  const Result result = run(buffer, network, PACKETS);
+
+  std::vector<size_t> concealed;
+  for (size_t i = 0; i < result.played.size(); ++i) {
+    if (result.played[i].block.concealed) {
+      concealed.push_back(i);
+    }
+  }
+  // 99 was played at index 99, so the concealment of 100 repeats it at half level
+  const Played &single = result.played[100];
+  const int16_t expected_half = left_sample(99 * FRAMES_PER_PACKET) >> 1;
+  // 200-202 are concealed, each 6 dB below the last; 203-205 are skipped and 206 plays right after, 15 ms later
+  const Played &third = result.played[202];
+  const Played &resumed = result.played[203];
+  // 300-302 are concealed, nothing is buffered behind them, and 340 starts over
+  const Played &restarted = result.played[300];
+
+  std::printf("concealment: played %zu, concealed %zu, lost %u, idle ticks %u\n", result.played.size(),
+              concealed.size(), buffer.get_lost_packets(), result.inactive_pops);
+  bool ok = check(concealed.size() == 7, "one block for the single loss, three per burst");
+  ok &= check(single.block.concealed && (single.first_left == expected_half), "single loss repeats at half level");
+  ok &= check(result.played[101].first_left == left_sample(101 * FRAMES_PER_PACKET), "101 follows the concealment");
+  ok &= check(third.block.concealed && (third.first_left == left_sample(199 * FRAMES_PER_PACKET) >> 3),
+              "third concealed block is 18 dB down");
+  ok &= check(!resumed.block.concealed && (resumed.first_left == left_sample(206 * FRAMES_PER_PACKET)) &&
+                  (resumed.block.presentation_us - third.block.presentation_us == 4 * PACKET_US),
+              "burst resumes at the next buffered packet on the same timeline");
+  ok &= check(!restarted.block.concealed && (restarted.first_left == left_sample(340 * FRAMES_PER_PACKET)) &&
+                  (restarted.block.presentation_us ==
+                   restarted.block.arrival_us + static_cast<int64_t>(buffer.get_target_delay_us())),
+              "after the talkspurt ends, the next packet starts a new timeline");
+  ok &= check(result.inactive_pops > 0, "the buffer goes idle during the long gap");
+  ok &= check(buffer.get_lost_packets() == 1 + 6 + 3, "lost packets counted once each, up to the talkspurt end");
+  ok &= check(result.played.size() == PACKETS - 47 + 7, "every packet that arrived plays");
+  return ok;
+}
+
+/// A sender clock running fast or slow would grow or drain the playout buffer without bound; the drift tracking
+/// re-anchors the timeline so the buffered time stays near the target and nothing arrives late
+bool test_drift(double sender_ppm) {
+  RtpJitterBuffer buffer;
+  buffer.configure(SAMPLE_RATE, CHANNELS, 2, MIN_DELAY_MS, MAX_DELAY_MS);
+  Network network;
+  network.sender_ppm = sender_ppm;
+  network.jitter_us = 2000;
+  constexpr uint32_t PACKETS = 36000;  // three minutes, past the 60 s anchor rebase
+  const Result result = run(buffer, network, PACKETS);
+
+  int64_t min_depth_us = INT64_MAX;
+  int64_t max_depth_us = INT64_MIN;
+  bool in_order = true;
+  for (size_t i = 0; i < result.played.size(); ++i) {
+    const PlayoutBlock &block = result.played[i].block;
+    if (block.concealed) {
+      in_order = false;
+      continue;
+    }
+    min_depth_us = std::min(min_depth_us, block.presentation_us - block.arrival_us);
+    max_depth_us = std::max(max_depth_us, block.presentation_us - block.arrival_us);
+    in_order &= result.played[i].first_left == left_sample(i * FRAMES_PER_PACKET);
+  }
+  const double uncorrected_ms = std::abs(sender_ppm) * 1e-6 * PACKETS * PACKET_US / 1000.0;
+  std::printf("drift %+.0f ppm: buffered %.1f to %.1f ms (uncorrected drift %.1f ms), late %u, lost %u\n", sender_ppm,
+              min_depth_us / 1000.0, max_depth_us / 1000.0, uncorrected_ms, buffer.get_late_packets(),
+              buffer.get_lost_packets());
+  bool ok = check(result.played.size() == PACKETS && in_order, "every packet plays in order");
+  ok &= check(buffer.get_late_packets() == 0 && buffer.get_lost_packets() == 0, "nothing late or lost");
+  ok &= check(min_depth_us > 0, "every packet is buffered before it is due");
+  ok &= check(max_depth_us - min_depth_us < static_cast<int64_t>(buffer.get_target_delay_us()) + 2 * PACKET_US,
+              "buffered time stays within the playout delay of its range");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= test_reorder();
+  ok &= test_concealment();
+  ok &= test_drift(+300.0);
+  ok &= test_drift(-300.0);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
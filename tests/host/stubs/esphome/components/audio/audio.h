@@ -0,0 +1,40 @@
+#pragma once
+
+// Host stand-in for ESPHome's audio.h: just the AudioStreamInfo accessors the components under test use
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome::audio {
+
+class AudioStreamInfo {
+ public:
+  AudioStreamInfo() : AudioStreamInfo(16, 1, 16000) {}
+  AudioStreamInfo(uint8_t bits_per_sample, uint8_t channels, uint32_t sample_rate)
+      : bits_per_sample_(bits_per_sample), channels_(channels), sample_rate_(sample_rate) {}
+
+  uint8_t get_bits_per_sample() const { return this->bits_per_sample_; }
+  uint8_t get_channels() const { return this->channels_; }
+  uint32_t get_sample_rate() const { return this->sample_rate_; }
+
+  bool operator==(const AudioStreamInfo &rhs) const {
+    return (this->bits_per_sample_ == rhs.bits_per_sample_) && (this->channels_ == rhs.channels_) &&
+           (this->sample_rate_ == rhs.sample_rate_);
+  }
+  bool operator!=(const AudioStreamInfo &rhs) const { return !(*this == rhs); }
+
+  uint32_t bytes_to_frames(size_t bytes) const { return bytes / this->frames_to_bytes(1); }
+  size_t samples_to_bytes(uint32_t samples) const { return samples * (this->bits_per_sample_ / 8); }
+  size_t frames_to_bytes(uint32_t frames) const { return frames * this->channels_ * (this->bits_per_sample_ / 8); }
+  uint32_t ms_to_frames(uint32_t ms) const { return (ms * this->sample_rate_) / 1000; }
+  uint32_t frames_to_microseconds(uint32_t frames) const {
+    return (frames * 1000000 + (this->sample_rate_ >> 1)) / this->sample_rate_;
+  }
+
+ protected:
+  uint8_t bits_per_sample_;
+  uint8_t channels_;
+  uint32_t sample_rate_;
+};
+
+}  // namespace esphome::audio
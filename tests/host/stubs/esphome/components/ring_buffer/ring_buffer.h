@@ -0,0 +1,125 @@
+#pragma once
+
+// Host stand-in for ESPHome's ring_buffer::RingBuffer. The firmware class wraps a FreeRTOS byte ring buffer, where
+// every send, receive and return takes the buffer's spinlock and gives or takes its semaphores, and a read that
+// crosses the end of the storage takes two receives. This models that with a mutex per FreeRTOS call and a condition
+// variable in place of the semaphores, so host timings show the cost of the locking design rather than of Xtensa
+// spinlocks.
+
+#include <freertos/FreeRTOS.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace esphome::ring_buffer {
+
+class RingBuffer {
+ public:
+  static std::unique_ptr<RingBuffer> create(size_t len) {
+    std::unique_ptr<RingBuffer> ring(new (std::nothrow) RingBuffer());
+    if (ring != nullptr) {
+      ring->storage_.resize(len);
+    }
+    return ring;
+  }
+
+  /// @brief Reads up to `len` bytes, waiting up to `ticks_to_wait` for the first of them.
+  size_t read(void *data, size_t len, TickType_t ticks_to_wait = 0) {
+    size_t bytes_read = this->receive_up_to_(static_cast<uint8_t *>(data), len, ticks_to_wait);
+    if ((bytes_read > 0) && (bytes_read < len)) {
+      // The data may have wrapped around the end of the storage, so receive a second time for the remainder
+      bytes_read += this->receive_up_to_(static_cast<uint8_t *>(data) + bytes_read, len - bytes_read, 0);
+    }
+    return bytes_read;
+  }
+
+  /// @brief Writes as much of `data` as fits, waiting up to `ticks_to_wait` for space.
+  size_t write_without_replacement(const void *data, size_t len, TickType_t ticks_to_wait = 0,
+                                   bool write_partial = true) {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    const auto has_space = [this, len, write_partial]() {
+      return write_partial ? (this->free_locked_() > 0) : (this->free_locked_() >= len);
+    };
+    if (!has_space() && !this->wait_(lock, ticks_to_wait, has_space)) {
+      return 0;
+    }
+    len = std::min(len, this->free_locked_());
+    const size_t first = std::min(len, this->storage_.size() - this->head_);
+    std::memcpy(this->storage_.data() + this->head_, data, first);
+    std::memcpy(this->storage_.data(), static_cast<const uint8_t *>(data) + first, len - first);
+    this->head_ = (this->head_ + len) % this->storage_.size();
+    this->used_ += len;
+    lock.unlock();
+    this->cv_.notify_all();
+    return len;
+  }
+
+  size_t write(const void *data, size_t len) { return this->write_without_replacement(data, len, 0); }
+
+  size_t available() const {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->used_;
+  }
+  size_t free() const {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->free_locked_();
+  }
+
+  BaseType_t reset() {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->head_ = 0;
+    this->tail_ = 0;
+    this->used_ = 0;
+    return pdTRUE;
+  }
+
+ protected:
+  RingBuffer() = default;
+
+  size_t free_locked_() const { return this->storage_.size() - this->used_; }
+
+  template<typename Ready> bool wait_(std::unique_lock<std::mutex> &lock, TickType_t ticks_to_wait, Ready ready) {
+    if (ticks_to_wait == 0) {
+      return false;
+    }
+    if (ticks_to_wait == portMAX_DELAY) {
+      this->cv_.wait(lock, ready);
+      return true;
+    }
+    return this->cv_.wait_for(lock, std::chrono::milliseconds(ticks_to_wait), ready);
+  }
+
+  /// @brief One xRingbufferReceiveUpTo() plus vRingbufferReturnItem(): at most the contiguous run at the tail.
+  size_t receive_up_to_(uint8_t *data, size_t len, TickType_t ticks_to_wait) {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    const auto has_data = [this]() { return this->used_ > 0; };
+    if (!has_data() && !this->wait_(lock, ticks_to_wait, has_data)) {
+      return 0;
+    }
+    const size_t run = std::min({len, this->used_, this->storage_.size() - this->tail_});
+    lock.unlock();
+    std::memcpy(data, this->storage_.data() + this->tail_, run);
+    lock.lock();
+    this->tail_ = (this->tail_ + run) % this->storage_.size();
+    this->used_ -= run;
+    lock.unlock();
+    this->cv_.notify_all();
+    return run;
+  }
+
+  std::vector<uint8_t> storage_;
+  size_t head_{0};
+  size_t tail_{0};
+  size_t used_{0};
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace esphome::ring_buffer
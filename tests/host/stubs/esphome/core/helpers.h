@@ -0,0 +1,16 @@
+#pragma once
+
+// Host stand-in for ESPHome's helpers.h: RAMAllocator on the C heap
+
+#include <cstddef>
+#include <cstdlib>
+
+namespace esphome {
+
+template<class T> class RAMAllocator {
+ public:
+  T *allocate(size_t n) { return static_cast<T *>(std::malloc(n * sizeof(T))); }
+  void deallocate(T *p, size_t /*n*/) { std::free(p); }
+};
+
+}  // namespace esphome
@@ -0,0 +1,68 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS task notifications the audio rings block on. Every thread acts as a task with its own
+// notification count; a tick is one millisecond of the steady clock.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+using TickType_t = uint32_t;
+using BaseType_t = int;
+using UBaseType_t = unsigned int;
+using TaskHandle_t = void *;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY static_cast<TickType_t>(0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms) static_cast<TickType_t>(ms)
+
+namespace freertos_host {
+
+struct TaskNotification {
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t count{0};
+};
+
+inline TaskNotification &current_task() {
+  static thread_local TaskNotification notification;
+  return notification;
+}
+
+}  // namespace freertos_host
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return &freertos_host::current_task(); }
+
+inline TickType_t xTaskGetTickCount() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return static_cast<TickType_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait) {
+  freertos_host::TaskNotification &task = freertos_host::current_task();
+  std::unique_lock<std::mutex> lock(task.mutex);
+  const auto notified = [&task]() { return task.count > 0; };
+  if (ticks_to_wait == portMAX_DELAY) {
+    task.cv.wait(lock, notified);
+  } else {
+    task.cv.wait_for(lock, std::chrono::milliseconds(ticks_to_wait), notified);
+  }
+  const uint32_t count = task.count;
+  if (count > 0) {
+    task.count = clear_count_on_exit ? 0 : count - 1;
+  }
+  return count;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task_handle) {
+  auto *task = static_cast<freertos_host::TaskNotification *>(task_handle);
+  {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    ++task->count;
+  }
+  task->cv.notify_one();
+  return pdTRUE;
+}
@@ -0,0 +1,135 @@
+// Plays one stream on two simulated speakers whose DMA clocks run at different ppm offsets from a shared reference
+// clock, with each speaker's SyncTracker repeating or skipping frames the way the speaker task does. Checks that the
+// two stay within 1 ms of each other for ten minutes, including across a step of the reference clock, and that the
+// tracker corrects the drift without hunting back and forth.
+
+#include "esphome/components/i2s_audio/speaker/speaker_sync_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+using esphome::i2s_audio::SyncTracker;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint32_t FRAMES_PER_DMA_BUFFER = 480;  // 10 ms
+constexpr size_t DMA_BUFFERS_QUEUED = 4;         // corrections reach the output this many buffers after they are made
+constexpr double DURATION_S = 600.0;
+constexpr int64_t TIMESTAMP_JITTER_US = 150;     // ISR latency plus reference clock noise, uniform +/-
+constexpr int64_t REFERENCE_STEP_US = 500000;    // e.g. an SNTP correction
+constexpr double REFERENCE_STEP_AT_S = 300.0;
+
+struct Speaker {
+  Speaker(const char *name, double ppm, uint8_t channels) : name(name), ppm(ppm), channels(channels) {}
+
+  const char *name;
+  double ppm;
+  uint8_t channels;
+
+  SyncTracker tracker;
+  std::deque<int64_t> queued_stream_frames;  // stream frames each queued DMA buffer advances the stream by
+  int64_t stream_frames_played{0};
+  int64_t corrected_frames_net{0};
+  int64_t corrected_frames_total{0};
+  uint64_t buffers_completed{0};
+  uint32_t jitter_seed{1};
+
+  void start() {
+    this->tracker.start(SAMPLE_RATE, this->channels);
+    this->queued_stream_frames.assign(DMA_BUFFERS_QUEUED, FRAMES_PER_DMA_BUFFER);
+  }
+
+  /// Reference clock time at which the next DMA buffer finishes, in true microseconds
+  double next_completion_us() const {
+    return (this->buffers_completed + 1) * FRAMES_PER_DMA_BUFFER * 1e6 / (SAMPLE_RATE * (1.0 + this->ppm * 1e-6));
+  }
+
+  /// Completes one DMA buffer and refills it the way the speaker task does
+  void complete_buffer(int64_t reference_offset_us) {
+    const double now_us = this->next_completion_us();
+    ++this->buffers_completed;
+    this->stream_frames_played += this->queued_stream_frames.front();
+    this->queued_stream_frames.pop_front();
+
+    this->jitter_seed = this->jitter_seed * 1664525u + 1013904223u;
+    const int64_t jitter_us = static_cast<int64_t>(this->jitter_seed >> 8) % (2 * TIMESTAMP_JITTER_US + 1) -
+                              TIMESTAMP_JITTER_US;
+    this->tracker.update(static_cast<int64_t>(now_us) + reference_offset_us + jitter_us, FRAMES_PER_DMA_BUFFER,
+                         FRAMES_PER_DMA_BUFFER);
+
+    // Repeating frames fills the buffer with fewer stream frames; skipping consumes extra ones
+    const int32_t pending = this->tracker.pending_frames();
+    this->queued_stream_frames.push_back(static_cast<int64_t>(FRAMES_PER_DMA_BUFFER) - pending);
+    if (pending != 0) {
+      this->tracker.correction_applied();
+      this->corrected_frames_net += pending;
+      this->corrected_frames_total += std::abs(pending);
+    }
+  }
+
+  /// How far the stream being heard leads true time, in microseconds
+  double lead_us() const {
+    return this->stream_frames_played * 1e6 / SAMPLE_RATE - (this->buffers_completed * FRAMES_PER_DMA_BUFFER * 1e6) /
+                                                              (SAMPLE_RATE * (1.0 + this->ppm * 1e-6));
+  }
+};
+
+bool simulate(double ppm_a, double ppm_b, uint8_t channels_b) {
+  Speaker speakers[2] = {{"A", ppm_a, 2}, {"B", ppm_b, channels_b}};
+  for (auto &speaker : speakers) {
+    speaker.start();
+  }
+
+  double max_spread_us = 0.0;
+  double max_lead_us[2] = {0.0, 0.0};
+  double now_us = 0.0;
+  while (now_us < DURATION_S * 1e6) {
+    // Advance whichever speaker finishes a buffer first so both see the same reference timeline
+    Speaker &next = speakers[0].next_completion_us() <= speakers[1].next_completion_us() ? speakers[0] : speakers[1];
+    now_us = next.next_completion_us();
+    next.complete_buffer(now_us >= REFERENCE_STEP_AT_S * 1e6 ? REFERENCE_STEP_US : 0);
+
+    const double spread_us = std::fabs(speakers[0].lead_us() - speakers[1].lead_us());
+    max_spread_us = std::max(max_spread_us, spread_us);
+    for (size_t i = 0; i < 2; ++i) {
+      max_lead_us[i] = std::max(max_lead_us[i], std::fabs(speakers[i].lead_us()));
+    }
+  }
+
+  const double uncorrected_spread_ms = std::fabs(ppm_a - ppm_b) * 1e-6 * DURATION_S * 1e3;
+  std::printf("A %+.0f ppm, B %+.0f ppm (%u ch): uncorrected spread %.1f ms, corrected spread max %.0f us\n", ppm_a,
+              ppm_b, channels_b, uncorrected_spread_ms, max_spread_us);
+
+  bool ok = max_spread_us < 1000.0;
+  for (size_t i = 0; i < 2; ++i) {
+    const Speaker &speaker = speakers[i];
+    const double expected_net = speaker.ppm * 1e-6 * SAMPLE_RATE * DURATION_S;
+    std::printf("  %s: max lead %.0f us, frames corrected net %+lld (drift %+.0f), total %lld\n", speaker.name,
+                max_lead_us[i], static_cast<long long>(speaker.corrected_frames_net), expected_net,
+                static_cast<long long>(speaker.corrected_frames_total));
+    // Each correction should move the stream toward the reference; any reversal is hunting around the deadband
+    const int64_t reversals = speaker.corrected_frames_total - std::llabs(speaker.corrected_frames_net);
+    ok &= max_lead_us[i] < 1000.0;
+    ok &= std::fabs(speaker.corrected_frames_net - expected_net) < 0.05 * std::fabs(expected_net) + 4;
+    ok &= reversals <= 8;
+  }
+  if (!ok) {
+    std::printf("  FAILED\n");
+  }
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= simulate(+60.0, -90.0, 2);
+  ok &= simulate(+20.0, +25.0, 2);
+  ok &= simulate(-150.0, +150.0, 1);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}